@@ -0,0 +1,1499 @@
+﻿/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// Benchmarks comparing library facilities against the alternatives they replace. Each benchmark can be run
+// by passing its name on the command line (e.g. "Benchmarks filestream"), otherwise all of them are run.
+// Passing "large" additionally includes the biggest sizes, which need several gigabytes of memory.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+
+#include "TinyTRL.h"
+
+using namespace trl;
+
+static String const directoryForTesting = "TestDirectory";
+
+// Names of benchmarks given on the command line.
+static char** benchmarkNames = nullptr;
+static int benchmarkNameCount = 0;
+
+// Whether the biggest sizes are included.
+static bool benchmarkLarge = false;
+
+// Results are accumulated here, so that the compiler cannot optimize away the measured work.
+static uint64_t volatile benchmarkSink = 0;
+
+// Accumulates the given result into the sink.
+static void benchmarkConsume(uint64_t const value)
+{
+  benchmarkSink = benchmarkSink + value;
+}
+
+// Tests whether a benchmark with the given name has been requested.
+static bool benchmarkSelected(char const* const name)
+{
+  bool any = false;
+
+  for (int i = 0; i < benchmarkNameCount; ++i)
+    if (!utility::sameText(benchmarkNames[i], "large"))
+    {
+      if (utility::sameText(benchmarkNames[i], name))
+        return true;
+      any = true;
+    }
+
+  return !any; // Run all benchmarks when none is named.
+}
+
+// Returns next number of SplitMix64 pseudo-random generator.
+static uint64_t benchmarkRandom(uint64_t& state)
+{
+  uint64_t value = (state += 0x9E3779B97F4A7C15ull);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+  return value ^ (value >> 31);
+}
+
+// Returns milliseconds that have elapsed since the given tick count.
+static double benchmarkElapsedMS(TickCount const start)
+{
+  return static_cast<double>(timingTickCountNS() - start) / 1000000.0;
+}
+
+// Returns nanoseconds per operation that have elapsed since the given tick count.
+static double benchmarkElapsed(TickCount const start, int64_t const operations)
+{
+  return static_cast<double>(timingTickCountNS() - start) / static_cast<double>(operations > 0 ? operations : 1);
+}
+
+// Returns megabytes per second processed since the given tick count.
+static double benchmarkThroughput(TickCount const start, int64_t const bytes)
+{
+  double const seconds = static_cast<double>(timingTickCountNS() - start) / 1000000000.0;
+  return static_cast<double>(bytes) / 1000000.0 / (seconds > 0.0 ? seconds : 1.0);
+}
+
+// Compares per-scalar write and read costs of unbuffered and buffered file streams.
+static void benchmarkFileStream()
+{
+  if (!FileStream::directoryExists(directoryForTesting) && !FileStream::createDirectory(directoryForTesting))
+  {
+    printf("Error! Could not create \"TestDirectory\"...\n");
+    return;
+  }
+  String const fileName = directoryForTesting + utility::PathDelimeter + "Benchmark.dat";
+  int64_t const count = benchmarkLarge ? 10000000 : 1000000;
+
+  printf("FileStream, %lld uint32_t scalars written and read one by one (ns per scalar):\n",
+    static_cast<long long>(count));
+
+  for (FileStream::FileMode const buffered : {0u, static_cast<FileStream::FileMode>(FileStream::ModeBuffered)})
+  {
+    TickCount start = timingTickCountNS();
+    {
+      FileStream stream(fileName, FileStream::ModeCreate | buffered);
+
+      for (int64_t i = 0; i < count; ++i)
+        stream.write<uint32_t>(static_cast<uint32_t>(i));
+
+      if (!stream)
+        printf("Error! Could not write benchmark file.\n");
+    }
+    double const writeTime = benchmarkElapsed(start, count);
+
+    start = timingTickCountNS();
+    {
+      FileStream stream(fileName, FileStream::ModeRead | buffered);
+      uint64_t sum = 0;
+
+      for (int64_t i = 0; i < count; ++i)
+        sum += stream.read<uint32_t>();
+
+      benchmarkConsume(sum);
+    }
+    double const readTime = benchmarkElapsed(start, count);
+
+    printf("  %-12s write %8.1f  read %8.1f\n", buffered ? "buffered" : "unbuffered", writeTime, readTime);
+  }
+  printf("\n");
+}
+
+// Fills an array with integers of the given pattern: random, sorted, reversed, organ pipe or all equal.
+static void benchmarkSortInput(Array<int64_t>& values, int64_t const count, int const pattern)
+{
+  uint64_t state = 1;
+
+  values.clear();
+  if (!values.length(count))
+    printf("Error! Could not allocate %lld elements.\n", static_cast<long long>(count));
+
+  for (int64_t i = 0; i < values.length(); ++i)
+    switch (pattern)
+    {
+    case 0:
+      values[i] = static_cast<int64_t>(benchmarkRandom(state) >> 1);
+      break;
+    case 1:
+      values[i] = i;
+      break;
+    case 2:
+      values[i] = count - i;
+      break;
+    case 3:
+      values[i] = i < count / 2 ? i : count - i;
+      break;
+    default:
+      values[i] = 0;
+      break;
+    }
+}
+
+// Compares QuickSort and IntroSort on random and degenerate inputs.
+static void benchmarkSort()
+{
+  char const* const patternNames[] = {"random", "sorted", "reversed", "organ pipe", "all equal"};
+  int64_t const counts[] = {10000, 1000000, 10000000};
+  int const countTotal = benchmarkLarge ? 3 : 2;
+
+  // QuickSort degrades to quadratic time and linear recursion depth on organ pipe and all-equal inputs,
+  // so it is only measured on those for the smallest size.
+  int64_t const quickSortDegenerateLimit = 10000;
+
+  printf("Sorting int64_t, quickSort() vs sort() (ms):\n");
+  printf("  %-10s %-11s %10s %10s\n", "count", "input", "quickSort", "sort");
+
+  Array<int64_t> values;
+
+  for (int countIndex = 0; countIndex < countTotal; ++countIndex)
+  {
+    int64_t const count = counts[countIndex];
+
+    for (int pattern = 0; pattern < 5; ++pattern)
+    {
+      double quickSortTime = -1.0;
+
+      if (pattern < 3 || count <= quickSortDegenerateLimit)
+      {
+        benchmarkSortInput(values, count, pattern);
+        TickCount const start = timingTickCountNS();
+        values.quickSort();
+        quickSortTime = benchmarkElapsedMS(start);
+        benchmarkConsume(static_cast<uint64_t>(values[count / 2]));
+      }
+
+      benchmarkSortInput(values, count, pattern);
+      TickCount const start = timingTickCountNS();
+      values.sort();
+      double const sortTime = benchmarkElapsedMS(start);
+      benchmarkConsume(static_cast<uint64_t>(values[count / 2]));
+
+      if (quickSortTime >= 0.0)
+        printf("  %-10lld %-11s %10.2f %10.2f\n", static_cast<long long>(count), patternNames[pattern],
+          quickSortTime, sortTime);
+      else
+        printf("  %-10lld %-11s %10s %10.2f\n", static_cast<long long>(count), patternNames[pattern], "-",
+          sortTime);
+    }
+  }
+  printf("\n");
+}
+
+// Fills an array with the given number of pseudo-random keys.
+static void benchmarkKeys(Array<int64_t>& keys, int64_t const count, uint64_t seed)
+{
+  keys.clear();
+  if (!keys.length(count))
+    printf("Error! Could not allocate %lld keys.\n", static_cast<long long>(count));
+
+  for (int64_t i = 0; i < keys.length(); ++i)
+    keys[i] = static_cast<int64_t>(benchmarkRandom(seed) >> 1);
+}
+
+// Fills an array with the given number of keys picked at random from another array.
+static void benchmarkPick(Array<int64_t>& queries, Array<int64_t> const& keys, int64_t const count, uint64_t seed)
+{
+  queries.clear();
+  if (!queries.length(count))
+    printf("Error! Could not allocate %lld queries.\n", static_cast<long long>(count));
+
+  for (int64_t i = 0; i < queries.length(); ++i)
+    queries[i] = keys[static_cast<int64_t>(benchmarkRandom(seed) % static_cast<uint64_t>(keys.length()))];
+}
+
+// Returns nanoseconds per lookup of the given keys in a map.
+template <typename Map, typename Key>
+static double benchmarkLookup(Map const& map, Array<Key> const& queries)
+{
+  TickCount const start = timingTickCountNS();
+  uint64_t found = 0;
+
+  for (Key const& query : queries)
+    found += map.value(query) != nullptr;
+
+  benchmarkConsume(found);
+  return benchmarkElapsed(start, queries.length());
+}
+
+// Returns nanoseconds per erase of the given keys from a map.
+template <typename Map>
+static double benchmarkErase(Map& map, Array<int64_t> const& keys)
+{
+  TickCount const start = timingTickCountNS();
+  uint64_t erased = 0;
+
+  for (int64_t const key : keys)
+    erased += map.erase(key);
+
+  benchmarkConsume(erased);
+  return benchmarkElapsed(start, keys.length());
+}
+
+// Compares open-addressing HashMap against FlatMap for insert, lookup and erase.
+static void benchmarkHashMap()
+{
+  int64_t const counts[] = {1000, 10000, 100000, 1000000, 10000000};
+  int const countTotal = benchmarkLarge ? 5 : 4;
+
+  // Inserting into FlatMap one by one is quadratic, so bigger maps are built at once with addRange().
+  int64_t const flatInsertLimit = 100000;
+
+  // Lookups use this many random queries, erases are measured over a fixed batch of keys.
+  int64_t const queryCount = 1000000;
+  int64_t const eraseCount = 1000;
+
+  printf("HashMap vs FlatMap, int64_t keys and values (ns per operation):\n");
+  printf("  %-10s %-8s %8s %8s %8s %8s\n", "count", "map", "insert", "hit", "miss", "erase");
+
+  Array<int64_t> keys, hits, misses, erases;
+
+  for (int countIndex = 0; countIndex < countTotal; ++countIndex)
+  {
+    int64_t const count = counts[countIndex];
+
+    benchmarkKeys(keys, count, 1);
+    benchmarkPick(hits, keys, queryCount, 2);
+    benchmarkKeys(misses, queryCount, 3);
+    benchmarkPick(erases, keys, eraseCount, 4);
+
+    {
+      HashMap<int64_t, int64_t> map;
+
+      TickCount const start = timingTickCountNS();
+      for (int64_t const key : keys)
+        map.addp(key, key);
+      double const insertTime = benchmarkElapsed(start, count);
+
+      if (!map)
+        printf("Error! Could not build HashMap.\n");
+
+      double const hitTime = benchmarkLookup(map, hits);
+      double const missTime = benchmarkLookup(map, misses);
+      double const eraseTime = benchmarkErase(map, erases);
+
+      printf("  %-10lld %-8s %8.1f %8.1f %8.1f %8.1f\n", static_cast<long long>(count), "HashMap", insertTime,
+        hitTime, missTime, eraseTime);
+    }
+    {
+      FlatMap<int64_t, int64_t> map;
+      double insertTime = -1.0;
+
+      if (count <= flatInsertLimit)
+      {
+        TickCount const start = timingTickCountNS();
+        for (int64_t const key : keys)
+          map.addp(key, key);
+        insertTime = benchmarkElapsed(start, count);
+      }
+      else
+      {
+        Array<FlatMap<int64_t, int64_t>::KeyValue> pairs;
+
+        for (int64_t const key : keys)
+          pairs.addp({key, key});
+
+        if (!map.addRange(static_cast<Array<FlatMap<int64_t, int64_t>::KeyValue>&&>(pairs)))
+          map.pollute();
+      }
+
+      if (!map)
+        printf("Error! Could not build FlatMap.\n");
+
+      double const hitTime = benchmarkLookup(map, hits);
+      double const missTime = benchmarkLookup(map, misses);
+      double const eraseTime = benchmarkErase(map, erases);
+
+      if (insertTime >= 0.0)
+        printf("  %-10s %-8s %8.1f %8.1f %8.1f %8.1f\n", "", "FlatMap", insertTime, hitTime, missTime, eraseTime);
+      else
+        printf("  %-10s %-8s %8s %8.1f %8.1f %8.1f\n", "", "FlatMap", "-", hitTime, missTime, eraseTime);
+    }
+  }
+  printf("\n");
+}
+
+// String wrapper that is not trivially relocatable, so arrays move it element by element.
+struct BenchmarkString
+{
+  String text;
+};
+
+// Integer with a user-provided move constructor, so arrays move it element by element.
+struct BenchmarkInteger
+{
+  int64_t value;
+
+  BenchmarkInteger(int64_t const value = 0) noexcept
+  : value(value)
+  {
+  }
+
+  BenchmarkInteger(BenchmarkInteger const&) noexcept = default;
+
+  BenchmarkInteger(BenchmarkInteger&& integer) noexcept
+  : value(integer.value)
+  {
+  }
+
+  BenchmarkInteger& operator = (BenchmarkInteger const&) noexcept = default;
+  BenchmarkInteger& operator = (BenchmarkInteger&&) noexcept = default;
+};
+
+// Prints nanoseconds per element of array growth by appending and of inserting into the middle.
+template <typename Element, typename Make>
+static void benchmarkRelocation(char const* const name, Make const& make)
+{
+  int64_t const growCount = benchmarkLarge ? 10000000 : 1000000;
+  int64_t const insertLength = 100000;
+  int64_t const insertCount = 10000;
+
+  Array<Element> source;
+  for (int64_t i = 0; i < growCount; ++i)
+    source.addp(make(i));
+
+  Array<Element> array;
+
+  TickCount start = timingTickCountNS();
+  for (int64_t i = 0; i < growCount; ++i)
+    array.addp(static_cast<Element&&>(source[i]));
+  double const growTime = benchmarkElapsed(start, growCount);
+
+  if (!array.length(insertLength))
+    array.pollute();
+
+  for (int64_t i = 0; i < insertCount; ++i)
+    source[i] = make(i);
+
+  start = timingTickCountNS();
+  for (int64_t i = 0; i < insertCount; ++i)
+    array.insertp(array.length() / 2, static_cast<Element&&>(source[i]));
+  double const insertTime = benchmarkElapsed(start, insertCount);
+
+  if (!array)
+    printf("Error! Could not fill array of %s.\n", name);
+
+  printf("  %-18s %8.1f %10.1f\n", name, growTime, insertTime);
+}
+
+// Compares element relocation of trivially relocatable types against types that are moved one by one.
+static void benchmarkRelocations()
+{
+  printf("Array relocation, append growth and inserts into the middle of 100K elements (ns per element):\n");
+  printf("  %-18s %8s %10s\n", "element", "append", "insert");
+
+  benchmarkRelocation<int64_t>("int64_t", [](int64_t const i) { return i; });
+  benchmarkRelocation<BenchmarkInteger>("BenchmarkInteger", [](int64_t const i) { return BenchmarkInteger(i); });
+  benchmarkRelocation<String>("String", [](int64_t const i) { return utility::intToStr(i); });
+  benchmarkRelocation<BenchmarkString>("BenchmarkString",
+    [](int64_t const i) { return BenchmarkString{utility::intToStr(i)}; });
+
+  printf("\n");
+}
+
+// Searches for a string match by comparing it at every position, as findStr() did before.
+static String::Length benchmarkScalarFindStr(StringView const string, StringView const match)
+{
+  String::Length const matchMaxLength = string.length() - match.length();
+
+  for (String::Length i = 0; i <= matchMaxLength; ++i)
+    if (::memcmp(match.data(), string.data() + i, match.length()) == 0)
+      return i;
+
+  return String::NotFound;
+}
+
+// Searches for a string match without case-sensitivity one character at a time, as findText() did before.
+static String::Length benchmarkScalarFindText(StringView const string, StringView const match)
+{
+  String::Length const matchMaxLength = string.length() - match.length();
+
+  for (String::Length j = 0; j <= matchMaxLength; ++j)
+  {
+    bool matched = true;
+
+    for (String::Length i = 0; i < match.length(); ++i)
+      if (utility::upperCase(static_cast<unsigned char>(match[i])) !=
+        utility::upperCase(static_cast<unsigned char>(string[j + i])))
+      {
+        matched = false;
+        break;
+      }
+
+    if (matched)
+      return j;
+  }
+  return String::NotFound;
+}
+
+// Searches for a character match one character at a time, as findChar() did before.
+static String::Length benchmarkScalarFindChar(StringView const string, char const charCode)
+{
+  for (String::Length i = 0; i < string.length(); ++i)
+    if (string[i] == charCode)
+      return i;
+
+  return String::NotFound;
+}
+
+// Repeats the search through the whole text and returns megabytes per second scanned.
+template <typename Find>
+static double benchmarkFindRepeated(String const& text, int64_t const repeats, String::Length const expected,
+  Find const& find)
+{
+  TickCount const start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (int64_t i = 0; i < repeats; ++i)
+  {
+    String::Length const position = find(text);
+    if (position != expected)
+    {
+      printf("Error! Search returned %lld instead of %lld.\n", static_cast<long long>(position),
+        static_cast<long long>(expected));
+      return 0.0;
+    }
+    sum += static_cast<uint64_t>(position);
+  }
+
+  benchmarkConsume(sum);
+  return benchmarkThroughput(start, text.length() * repeats);
+}
+
+// Compares vectorized findStr(), findText() and findChar() against the scalar loops they replaced.
+static void benchmarkFind()
+{
+  String::Length const length = 1000000;
+  int64_t const repeats = benchmarkLarge ? 1000 : 100;
+
+  // Lowercase words without "z", so that only the match at the very end contains it.
+  String text;
+  uint64_t state = 1;
+
+  while (text.length() < length - 8)
+  {
+    uint64_t const random = benchmarkRandom(state);
+    text += random % 6 ? static_cast<char>('a' + (random >> 8) % 25) : ' ';
+  }
+  String::Length const expected = text.length() + 1;
+  text += " zipper.";
+
+  if (!text)
+  {
+    printf("Error! Could not create search text.\n");
+    return;
+  }
+
+  printf("Searching for a match at the end of %lld KB of text, %lld times (MB/s):\n",
+    static_cast<long long>(text.length() / 1000), static_cast<long long>(repeats));
+  printf("  %-26s %8s %8s\n", "search", "vector", "scalar");
+
+  double const strTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return utility::findStr(string, "zipper"); });
+  double const strScalarTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return benchmarkScalarFindStr(string, "zipper"); });
+  printf("  %-26s %8.1f %8.1f\n", "findStr() of \"zipper\"", strTime, strScalarTime);
+
+  double const textTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return utility::findText(string, "ZipPer"); });
+  double const textScalarTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return benchmarkScalarFindText(string, "ZipPer"); });
+  printf("  %-26s %8.1f %8.1f\n", "findText() of \"ZipPer\"", textTime, textScalarTime);
+
+  double const charTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return utility::findChar(string, 'z'); });
+  double const charScalarTime = benchmarkFindRepeated(text, repeats, expected,
+    [](StringView const string) { return benchmarkScalarFindChar(string, 'z'); });
+  printf("  %-26s %8.1f %8.1f\n\n", "findChar() of 'z'", charTime, charScalarTime);
+}
+
+// Creates UTF-8 text of about the given size made of spaces and random characters of the given code range.
+static String benchmarkUnicodeText(int64_t const bytes, uint32_t const first, uint32_t const count)
+{
+  String text;
+  uint64_t state = 1;
+
+  while (text.length() < bytes && text)
+  {
+    uint64_t const random = benchmarkRandom(state);
+    uint32_t const code = random % 8 ? first + static_cast<uint32_t>((random >> 8) % count) : ' ';
+
+    if (code < 0x80)
+      text += static_cast<char>(code);
+    else if (code < 0x800)
+    {
+      text += static_cast<char>(0xC0 | (code >> 6));
+      text += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else
+    {
+      text += static_cast<char>(0xE0 | (code >> 12));
+      text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      text += static_cast<char>(0x80 | (code & 0x3F));
+    }
+  }
+  return text;
+}
+
+// Prints throughput of UTF-8 to UTF-16 and back conversions of the given text.
+static void benchmarkUnicodeConversion(char const* const name, String const& text, int64_t const repeats)
+{
+  WideString::Length const wideLength = utility::convertUTF8ToUTF16(nullptr, text.data(), text.length());
+  Array<WideString::WideChar> wide;
+  String narrow;
+
+  if (!text || !wide.length(wideLength) || !narrow.length(text.length()))
+  {
+    printf("Error! Could not create %s text.\n", name);
+    return;
+  }
+
+  TickCount start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (int64_t i = 0; i < repeats; ++i)
+    sum += static_cast<uint64_t>(utility::convertUTF8ToUTF16(wide.data(), text.data(), text.length()));
+
+  benchmarkConsume(sum);
+  double const wideTime = benchmarkThroughput(start, text.length() * repeats);
+
+  start = timingTickCountNS();
+  sum = 0;
+
+  for (int64_t i = 0; i < repeats; ++i)
+    sum += static_cast<uint64_t>(utility::convertUTF16ToUTF8(narrow.data(), wide.data(), wideLength));
+
+  benchmarkConsume(sum);
+  double const narrowTime = benchmarkThroughput(start, text.length() * repeats);
+
+  if (narrow != text)
+    printf("Error! Converting %s text back to UTF-8 did not reproduce it.\n", name);
+
+  printf("  %-10s %10.1f %10.1f\n", name, wideTime, narrowTime);
+}
+
+// Measures UTF-8 and UTF-16 conversion throughput on text of different scripts.
+static void benchmarkUnicode()
+{
+  int64_t const bytes = 4000000;
+  int64_t const repeats = benchmarkLarge ? 250 : 25;
+
+  printf("Converting %lld MB of UTF-8 text to UTF-16 and back, %lld times (MB/s of UTF-8):\n",
+    static_cast<long long>(bytes / 1000000), static_cast<long long>(repeats));
+  printf("  %-10s %10s %10s\n", "text", "to UTF-16", "to UTF-8");
+
+  benchmarkUnicodeConversion("ASCII", benchmarkUnicodeText(bytes, 'a', 26), repeats);
+  benchmarkUnicodeConversion("Cyrillic", benchmarkUnicodeText(bytes, 0x0410, 64), repeats);
+  benchmarkUnicodeConversion("CJK", benchmarkUnicodeText(bytes, 0x4E00, 20992), repeats);
+
+  printf("\n");
+}
+
+// Simulates requests that each fill a number of short-lived arrays with the given allocator and calls the
+// given function at the end of every request. Returns nanoseconds per request.
+template <typename Alloc, typename EndRequest>
+static double benchmarkArenaRequests(int64_t const requestCount, Alloc const& alloc, EndRequest const& endRequest)
+{
+  int64_t const arrayCount = 16;
+  int64_t const valueCount = 1024;
+
+  TickCount const start = timingTickCountNS();
+  uint64_t state = 1;
+  uint64_t sum = 0;
+
+  for (int64_t request = 0; request < requestCount; ++request)
+  {
+    {
+      auto arrays = Array<Array<int64_t, Alloc>, Alloc>(Alloc(alloc));
+
+      for (int64_t i = 0; i < arrayCount; ++i)
+        arrays.addp(Array<int64_t, Alloc>(Alloc(alloc)));
+
+      // Arrays grow side by side, as they would while a request is being processed.
+      for (int64_t i = 0; i < valueCount; ++i)
+        arrays[static_cast<int64_t>(benchmarkRandom(state) % arrayCount)].addp(i);
+
+      for (Array<int64_t, Alloc> const& values : arrays)
+      {
+        if (!values)
+        {
+          printf("Error! Could not fill request arrays.\n");
+          return 0.0;
+        }
+        sum += static_cast<uint64_t>(values.length());
+      }
+    }
+    endRequest();
+  }
+
+  benchmarkConsume(sum);
+  return benchmarkElapsed(start, requestCount);
+}
+
+// Compares short-lived arrays allocated from a MonotonicArena, which is reset after each request, against
+// arrays using the default allocator.
+static void benchmarkArena()
+{
+  int64_t const requestCount = benchmarkLarge ? 2000000 : 200000;
+
+  printf("%lld requests, each filling 16 arrays with 1024 integers in total (ns per request):\n",
+    static_cast<long long>(requestCount));
+  printf("  %-30s %8s\n", "allocator", "time");
+
+  double const defaultTime = benchmarkArenaRequests(requestCount, Allocator(), [] {});
+  printf("  %-30s %8.1f\n", "Allocator", defaultTime);
+
+  MonotonicArena<> arena;
+  double const arenaTime = benchmarkArenaRequests(requestCount, ArenaAllocator<>(arena), [&arena] { arena.reset(); });
+  printf("  %-30s %8.1f\n\n", "ArenaAllocator, reset() after", arenaTime);
+}
+
+// Compares lookups of string keys against lookups of interned atoms, and measures cost of interning.
+static void benchmarkStringPool()
+{
+  int64_t const keyCount = 2000;
+  int64_t const queryCount = 1000000;
+
+  StringPool pool;
+  Array<String> keys;
+  Array<Atom> atoms;
+  uint64_t state = 1;
+
+  // Keys of 40 characters sharing a common prefix, as identifiers usually do.
+  for (int64_t i = 0; i < keyCount; ++i)
+  {
+    String key = "assets/textures/";
+    utility::appendUInt(key, benchmarkRandom(state) | (1ull << 63), 16);
+    key += ".texture";
+
+    atoms.addp(pool.intern(key));
+    keys.addp(static_cast<String&&>(key));
+  }
+
+  Array<String> stringQueries;
+  Array<Atom> atomQueries;
+
+  for (int64_t i = 0; i < queryCount; ++i)
+  {
+    int64_t const index = static_cast<int64_t>(benchmarkRandom(state) % static_cast<uint64_t>(keyCount));
+    stringQueries.addp(keys[index]);
+    atomQueries.addp(atoms[index]);
+  }
+
+  FlatMap<String, int64_t> stringFlatMap;
+  FlatMap<Atom, int64_t> atomFlatMap;
+  HashMap<String, int64_t, utility::StringHasher> stringHashMap;
+  HashMap<Atom, int64_t, utility::AtomHasher> atomHashMap;
+
+  for (int64_t i = 0; i < keyCount; ++i)
+  {
+    stringFlatMap.addp(keys[i], i);
+    atomFlatMap.addp(atoms[i], i);
+    stringHashMap.addp(keys[i], i);
+    atomHashMap.addp(atoms[i], i);
+  }
+
+  if (!pool || !stringQueries || !atomQueries || !stringFlatMap || !atomFlatMap || !stringHashMap ||
+    !atomHashMap)
+  {
+    printf("Error! Could not build string pool benchmark.\n");
+    return;
+  }
+
+  printf("StringPool, %lld keys of 40 characters, %lld random lookups (ns per lookup):\n",
+    static_cast<long long>(keyCount), static_cast<long long>(queryCount));
+  printf("  %-8s %8s %8s\n", "map", "String", "Atom");
+
+  double const stringFlatTime = benchmarkLookup(stringFlatMap, stringQueries);
+  double const atomFlatTime = benchmarkLookup(atomFlatMap, atomQueries);
+  printf("  %-8s %8.1f %8.1f\n", "FlatMap", stringFlatTime, atomFlatTime);
+
+  double const stringHashTime = benchmarkLookup(stringHashMap, stringQueries);
+  double const atomHashTime = benchmarkLookup(atomHashMap, atomQueries);
+  printf("  %-8s %8.1f %8.1f\n", "HashMap", stringHashTime, atomHashTime);
+
+  TickCount const start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (String const& query : stringQueries)
+    sum += pool.intern(query).hash();
+
+  benchmarkConsume(sum);
+  printf("  intern() of existing key: %.1f\n\n", benchmarkElapsed(start, queryCount));
+}
+
+// Compares splitting of CSV text by allocation-free split ranges against searching and copying fields.
+static void benchmarkSplit()
+{
+  int64_t const rowCount = benchmarkLarge ? 36000000 : 4000000;
+  uint64_t state = 1;
+  String csv;
+
+  for (int64_t row = 0; row < rowCount; ++row)
+  {
+    for (int field = 0; field < 4; ++field)
+    {
+      if (field > 0)
+        csv += ',';
+      utility::appendUInt(csv, benchmarkRandom(state) % 10000000);
+    }
+    csv += '\n';
+  }
+
+  if (!csv)
+  {
+    printf("Error! Could not create CSV text.\n");
+    return;
+  }
+  int64_t const bytes = csv.length();
+
+  printf("Splitting %lld MB of CSV text, %lld rows of 4 fields (MB/s):\n", static_cast<long long>(bytes / 1000000),
+    static_cast<long long>(rowCount));
+
+  TickCount start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (StringView const line : utility::split(csv, '\n'))
+    for (StringView const field : utility::split(line, ','))
+      sum += static_cast<uint64_t>(field.length());
+
+  benchmarkConsume(sum);
+  printf("  %-28s %8.1f\n", "split() lines, then commas", benchmarkThroughput(start, bytes));
+
+  start = timingTickCountNS();
+  sum = 0;
+
+  for (String::Length lineStart = 0; lineStart < csv.length();)
+  {
+    String::Length lineEnd = utility::findChar(csv, '\n', lineStart);
+    if (lineEnd == String::NotFound)
+      lineEnd = csv.length();
+
+    String const line = csv.substr(lineStart, lineEnd - lineStart);
+
+    for (String::Length fieldStart = 0;;)
+    {
+      String::Length const fieldEnd = utility::findChar(line, ',', fieldStart);
+      String const field = line.substr(fieldStart,
+        fieldEnd != String::NotFound ? fieldEnd - fieldStart : String::NotFound);
+
+      sum += static_cast<uint64_t>(field.length());
+
+      if (fieldEnd == String::NotFound)
+        break;
+      fieldStart = fieldEnd + 1;
+    }
+    lineStart = lineEnd + 1;
+  }
+
+  benchmarkConsume(sum);
+  printf("  %-28s %8.1f\n", "findChar() and substr()", benchmarkThroughput(start, bytes));
+
+  start = timingTickCountNS();
+  sum = 0;
+
+  for (StringView const field : utility::splitAny(csv, ",\n"))
+    sum += static_cast<uint64_t>(field.length());
+
+  benchmarkConsume(sum);
+  printf("  %-28s %8.1f\n\n", "splitAny() by \",\\n\"", benchmarkThroughput(start, bytes));
+}
+
+// Parses all newline-separated numbers of the feed and returns nanoseconds per number.
+template <typename Value, typename Parse>
+static double benchmarkParseFeed(String const& feed, int64_t const count, Parse const& parse)
+{
+  char const* const data = feed.data();
+  String::Length const length = feed.length();
+
+  TickCount const start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (String::Length position = 0; position < length;)
+  {
+    Value value = 0;
+    String::Length const consumed = parse(value, data + position, length - position);
+    if (consumed <= 0)
+    {
+      printf("Error! Could not parse number at %lld.\n", static_cast<long long>(position));
+      break;
+    }
+    sum += static_cast<uint64_t>(value);
+    position += consumed + 1;
+  }
+
+  benchmarkConsume(sum);
+  return benchmarkElapsed(start, count);
+}
+
+// Verifies that strToInt() accepts and rejects the same edge cases on every platform.
+static void benchmarkParseChecks()
+{
+  struct Check
+  {
+    char const* text;
+    int32_t base;
+    bool valid;
+    int64_t value;
+  };
+  static Check const checks[] = {
+    {"", 0, false, 0},
+    {"0", 0, true, 0},
+    {"0x", 0, false, 0},
+    {"0X", 16, false, 0},
+    {"0xg", 0, false, 0},
+    {"0x1f", 0, true, 31},
+    {"0x1f", 16, true, 31},
+    {"077", 0, true, 63},
+    {"08", 0, false, 0},
+    {"078", 0, false, 0},
+    {"08", 10, true, 8},
+    {" -12", 0, true, -12},
+    {"12abc", 0, true, 12},
+    {"9223372036854775807", 0, true, INT64_MAX},
+    {"-9223372036854775808", 0, true, INT64_MIN},
+    {"9223372036854775808", 0, false, 0}};
+
+  for (Check const& check : checks)
+  {
+    int64_t value = -1;
+    bool const valid = utility::strToInt(value, check.text, check.base);
+    if (valid != check.valid || value != (valid ? check.value : -1))
+      printf("Error! strToInt(\"%s\", %d) returned %s with %lld.\n", check.text, check.base,
+        valid ? "true" : "false", static_cast<long long>(value));
+  }
+}
+
+// Compares freestanding number parsers against strtod(), strtof() and strtoll() of C runtime.
+static void benchmarkParse()
+{
+  benchmarkParseChecks();
+
+  int64_t const count = benchmarkLarge ? 10000000 : 1000000;
+
+  String doubles, floats, longIntegers, randomIntegers;
+  uint64_t state = 1;
+
+  for (int64_t i = 0; i < count; ++i)
+  {
+    double const value = static_cast<double>(benchmarkRandom(state) >> 11) / 9007199254740992.0 * 1000000.0;
+
+    utility::appendDouble(doubles, value) += '\n';
+    utility::appendFloat(floats, static_cast<float>(value)) += '\n';
+    utility::appendUInt(longIntegers, 1000000000000000ull + benchmarkRandom(state) % 9000000000000000ull) += '\n';
+    uint64_t const shift = 1 + benchmarkRandom(state) % 63;
+    utility::appendUInt(randomIntegers, benchmarkRandom(state) >> shift) += '\n';
+  }
+
+  if (!doubles || !floats || !longIntegers || !randomIntegers)
+  {
+    printf("Error! Could not create number feeds.\n");
+    return;
+  }
+
+  printf("Parsing %lld newline-separated numbers (ns per number):\n", static_cast<long long>(count));
+  printf("  %-22s %8s %8s\n", "input", "parse", "libc");
+
+  double const parseDoubleTime = benchmarkParseFeed<double>(doubles, count,
+    [](double& value, char const* const text, String::Length const length)
+    {
+      return utility::parseDouble(value, StringView(text, length));
+    });
+  double const strtodTime = benchmarkParseFeed<double>(doubles, count,
+    [](double& value, char const* const text, String::Length)
+    {
+      char* end = nullptr;
+      value = strtod(text, &end);
+      return static_cast<String::Length>(end - text);
+    });
+  printf("  %-22s %8.1f %8.1f\n", "double, shortest", parseDoubleTime, strtodTime);
+
+  double const parseFloatTime = benchmarkParseFeed<float>(floats, count,
+    [](float& value, char const* const text, String::Length const length)
+    {
+      return utility::parseFloat(value, StringView(text, length));
+    });
+  double const strtofTime = benchmarkParseFeed<float>(floats, count,
+    [](float& value, char const* const text, String::Length)
+    {
+      char* end = nullptr;
+      value = strtof(text, &end);
+      return static_cast<String::Length>(end - text);
+    });
+  printf("  %-22s %8.1f %8.1f\n", "float, shortest", parseFloatTime, strtofTime);
+
+  auto const parseInt = [](int64_t& value, char const* const text, String::Length const length)
+  {
+    return utility::parseInt(value, StringView(text, length), 10);
+  };
+  auto const strtollInt = [](int64_t& value, char const* const text, String::Length)
+  {
+    char* end = nullptr;
+    value = strtoll(text, &end, 10);
+    return static_cast<String::Length>(end - text);
+  };
+
+  double const parseLongTime = benchmarkParseFeed<int64_t>(longIntegers, count, parseInt);
+  double const strtollLongTime = benchmarkParseFeed<int64_t>(longIntegers, count, strtollInt);
+  printf("  %-22s %8.1f %8.1f\n", "int64_t, 16 digits", parseLongTime, strtollLongTime);
+
+  double const parseRandomTime = benchmarkParseFeed<int64_t>(randomIntegers, count, parseInt);
+  double const strtollRandomTime = benchmarkParseFeed<int64_t>(randomIntegers, count, strtollInt);
+  printf("  %-22s %8.1f %8.1f\n\n", "int64_t, random length", parseRandomTime, strtollRandomTime);
+}
+
+// Parses every line of the log as one request under a scope of the given resource, copying its fields into
+// strings and joining them into a summary, then calls the given function at the end of every request.
+// Returns megabytes per second of the log.
+template <typename EndRequest>
+static double benchmarkScopedParse(String const& log, MemoryResource* const resource, EndRequest const& endRequest)
+{
+  Array<String> fields;
+  TickCount const start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (StringView const line : utility::split(log, '\n'))
+  {
+    {
+      ResourceScope scope(resource);
+
+      for (StringView const field : utility::split(line, ','))
+        fields.addp(field.string());
+
+      String summary;
+
+      for (String const& field : fields)
+      {
+        summary += utility::upperCase(field);
+        summary += ';';
+      }
+
+      if (!fields || !summary)
+      {
+        printf("Error! Could not parse log line.\n");
+        return 0.0;
+      }
+      sum += static_cast<uint64_t>(summary.length());
+
+      // Strings must be released before the arena behind the resource is reset.
+      fields.clear();
+    }
+    endRequest();
+  }
+
+  benchmarkConsume(sum);
+  return benchmarkThroughput(start, log.length());
+}
+
+// Compares string-heavy parsing of log lines with strings allocated from a MonotonicArena, which is reset
+// after each line, against strings allocated with C heap functions.
+static void benchmarkResourceScope()
+{
+  int64_t const lineCount = benchmarkLarge ? 2000000 : 200000;
+  uint64_t state = 1;
+  String log;
+
+  // Fields are longer than short strings, so that every copy allocates memory.
+  for (int64_t line = 0; line < lineCount; ++line)
+  {
+    log += "path=/assets/textures/";
+    utility::appendUInt(log, benchmarkRandom(state) | (1ull << 63), 16);
+    log += ".texture,user=account-";
+    utility::appendUInt(log, benchmarkRandom(state) % 1000000000);
+    log += "@example.com,agent=Mozilla/5.0 (X11; Linux x86_64),status=completed in ";
+    utility::appendUInt(log, benchmarkRandom(state) % 1000);
+    log += " milliseconds\n";
+  }
+
+  if (!log)
+  {
+    printf("Error! Could not create log text.\n");
+    return;
+  }
+
+  printf("Parsing %lld MB of log text, %lld lines of 4 fields copied into strings (MB/s):\n",
+    static_cast<long long>(log.length() / 1000000), static_cast<long long>(lineCount));
+  printf("  %-34s %8s\n", "resource", "parse");
+
+  double const heapTime = benchmarkScopedParse(log, nullptr, [] {});
+  printf("  %-34s %8.1f\n", "C heap", heapTime);
+
+  MonotonicArena<> arena;
+  AllocatorResource<ArenaAllocator<>> resource(arena);
+
+  double const arenaTime = benchmarkScopedParse(log, &resource, [&arena] { arena.reset(); });
+  printf("  %-34s %8.1f\n\n", "MonotonicArena, reset() after line", arenaTime);
+}
+
+// Appends all values separated by commas with the given function and returns nanoseconds per value.
+template <typename Append>
+static double benchmarkFormatValues(Array<double> const& values, Append const& append)
+{
+  TickCount const start = timingTickCountNS();
+  String text;
+
+  for (double const value : values)
+  {
+    append(text, value);
+    text += ',';
+  }
+
+  if (!text)
+    printf("Error! Could not format values.\n");
+
+  benchmarkConsume(static_cast<uint64_t>(text.length()));
+  return benchmarkElapsed(start, values.length());
+}
+
+// Compares formatting of doubles by appendDouble() against snprintf() of C runtime.
+static void benchmarkFormat()
+{
+  int64_t const count = benchmarkLarge ? 10000000 : 1000000;
+
+  Array<double> values;
+  uint64_t state = 1;
+
+  for (int64_t i = 0; i < count; ++i)
+    values.addp(static_cast<double>(benchmarkRandom(state) >> 11) / 9007199254740992.0 * 1000000.0);
+
+  printf("Appending %lld doubles and commas to a string (ns per value):\n", static_cast<long long>(count));
+  printf("  %-10s %12s %10s\n", "format", "appendDouble", "snprintf");
+
+  double const shortestTime = benchmarkFormatValues(values,
+    [](String& text, double const value)
+    {
+      utility::appendDouble(text, value);
+    });
+  double const shortestPrintfTime = benchmarkFormatValues(values,
+    [](String& text, double const value)
+    {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.17g", value);
+      text += buffer;
+    });
+  printf("  %-10s %12.1f %10.1f\n", "shortest", shortestTime, shortestPrintfTime);
+
+  double const fixedTime = benchmarkFormatValues(values,
+    [](String& text, double const value)
+    {
+      utility::appendDouble(text, value, FloatFormat::Fixed, 6);
+    });
+  double const fixedPrintfTime = benchmarkFormatValues(values,
+    [](String& text, double const value)
+    {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.6f", value);
+      text += buffer;
+    });
+  printf("  %-10s %12.1f %10.1f\n\n", "fixed 6", fixedTime, fixedPrintfTime);
+}
+
+// Standard map with the subset of library map interface used by benchmarks.
+struct BenchmarkStdMap : std::map<int64_t, int64_t>
+{
+  BenchmarkStdMap& addp(int64_t const key, int64_t const value)
+  {
+    emplace(key, value);
+    return *this;
+  }
+
+  int64_t const* value(int64_t const key) const
+  {
+    auto const position = find(key);
+    return position != end() ? &position->second : nullptr;
+  }
+
+  explicit operator bool () const
+  {
+    return true;
+  }
+};
+
+// Returns nanoseconds per pair of one insert of a new key and one erase of an existing key.
+template <typename Map>
+static double benchmarkChurn(Map& map, Array<int64_t> const& inserts, Array<int64_t> const& erases,
+  int64_t const count)
+{
+  TickCount const start = timingTickCountNS();
+  uint64_t erased = 0;
+
+  for (int64_t i = 0; i < count; ++i)
+  {
+    map.addp(inserts[i], inserts[i]);
+    erased += map.erase(erases[i]);
+  }
+
+  if (!map)
+    printf("Error! Could not insert into map.\n");
+
+  benchmarkConsume(erased);
+  return benchmarkElapsed(start, count);
+}
+
+// Compares ordered maps on random inserts and erases that keep their size, and on random lookups.
+static void benchmarkMaps()
+{
+  int64_t const counts[] = {10000, 1000000, 10000000};
+  int const countTotal = benchmarkLarge ? 3 : 2;
+
+  // Each insert into FlatMap moves half of elements on average, so fewer operations are timed on big maps.
+  int64_t const churnCount = 100000;
+  int64_t const flatChurnCount = 1000;
+  int64_t const queryCount = 1000000;
+
+  printf("Ordered maps, int64_t keys and values (ns per operation):\n");
+  printf("  %-10s %-10s %12s %8s\n", "count", "map", "insert+erase", "lookup");
+
+  Array<int64_t> keys, inserts, erases, hits;
+
+  for (int countIndex = 0; countIndex < countTotal; ++countIndex)
+  {
+    int64_t const count = counts[countIndex];
+
+    benchmarkKeys(keys, count, 1);
+    benchmarkKeys(inserts, churnCount, 2);
+    benchmarkPick(hits, keys, queryCount, 3);
+
+    // Keys are random, so initial keys are erased in random order, followed by keys inserted meanwhile.
+    erases.clear();
+    for (int64_t i = 0; i < churnCount; ++i)
+      erases.addp(i < count ? keys[i] : inserts[i - count]);
+
+    {
+      FlatMap<int64_t, int64_t> map;
+      Array<FlatMap<int64_t, int64_t>::KeyValue> pairs;
+
+      for (int64_t const key : keys)
+        pairs.addp({key, key});
+
+      if (!map.addRange(static_cast<Array<FlatMap<int64_t, int64_t>::KeyValue>&&>(pairs)))
+        map.pollute();
+
+      double const lookupTime = benchmarkLookup(map, hits);
+      double const churnTime = benchmarkChurn(map, inserts, erases,
+        count > churnCount ? flatChurnCount : churnCount);
+
+      printf("  %-10lld %-10s %12.1f %8.1f\n", static_cast<long long>(count), "FlatMap", churnTime, lookupTime);
+    }
+    {
+      Map<int64_t, int64_t> map;
+
+      for (int64_t const key : keys)
+        map.addp(key, key);
+
+      double const lookupTime = benchmarkLookup(map, hits);
+      double const churnTime = benchmarkChurn(map, inserts, erases, churnCount);
+
+      printf("  %-10s %-10s %12.1f %8.1f\n", "", "Map", churnTime, lookupTime);
+    }
+    {
+      BenchmarkStdMap map;
+
+      for (int64_t const key : keys)
+        map.addp(key, key);
+
+      double const lookupTime = benchmarkLookup(map, hits);
+      double const churnTime = benchmarkChurn(map, inserts, erases, churnCount);
+
+      printf("  %-10s %-10s %12.1f %8.1f\n", "", "std::map", churnTime, lookupTime);
+    }
+  }
+  printf("\n");
+}
+
+// Returns nanoseconds per lookup of the given keys in a map by classic binary search with early exit.
+template <typename Map, typename Key>
+static double benchmarkBranchyLookup(Map const& map, Array<Key> const& queries)
+{
+  DefaultComparer<Key> const comparer;
+  typename Map::KeyValue const* const pairs = map.begin();
+
+  TickCount const start = timingTickCountNS();
+  uint64_t sum = 0;
+
+  for (Key const& query : queries)
+  {
+    int64_t left = 0, right = map.length() - 1;
+
+    while (left <= right)
+    {
+      int64_t const middle = left + (right - left) / 2;
+      auto const comparison = comparer(pairs[middle].key, query);
+
+      if (comparison < 0)
+        left = middle + 1;
+      else if (comparison > 0)
+        right = middle - 1;
+      else
+      {
+        sum += static_cast<uint64_t>(pairs[middle].value);
+        break;
+      }
+    }
+  }
+
+  benchmarkConsume(sum);
+  return benchmarkElapsed(start, queries.length());
+}
+
+// Prints lookup latency of FlatMap and of classic binary search for maps of growing sizes.
+template <typename Key, typename MakeKey>
+static void benchmarkSearchKeys(char const* const name, int const countTotal, MakeKey const& makeKey)
+{
+  int64_t const counts[] = {1000, 10000, 100000, 1000000, 10000000, 100000000};
+  int64_t const queryCount = 1000000;
+
+  for (int countIndex = 0; countIndex < countTotal; ++countIndex)
+  {
+    int64_t const count = counts[countIndex];
+    uint64_t state = 1;
+
+    FlatMap<Key, int64_t> map;
+    {
+      Array<typename FlatMap<Key, int64_t>::KeyValue> pairs;
+
+      for (int64_t i = 0; i < count; ++i)
+        pairs.addp({makeKey(benchmarkRandom(state)), i});
+
+      if (!map.addRange(static_cast<Array<typename FlatMap<Key, int64_t>::KeyValue>&&>(pairs)))
+        map.pollute();
+    }
+
+    // Half of queries are keys of the map, while another half are most likely missing from it.
+    Array<Key> queries;
+
+    for (int64_t i = 0; i < queryCount; ++i)
+      if (benchmarkRandom(state) & 1)
+        queries.addp(map.begin()[benchmarkRandom(state) % static_cast<uint64_t>(map.length())].key);
+      else
+        queries.addp(makeKey(benchmarkRandom(state)));
+
+    if (!map || !queries)
+    {
+      printf("Error! Could not build map of %lld keys.\n", static_cast<long long>(count));
+      return;
+    }
+
+    double const branchyTime = benchmarkBranchyLookup(map, queries);
+    double const flatTime = benchmarkLookup(map, queries);
+
+    printf("  %-8s %-10lld %10.1f %10.1f\n", name, static_cast<long long>(count), branchyTime, flatTime);
+  }
+}
+
+// Compares FlatMap lookups against classic binary search with early exit.
+static void benchmarkSearch()
+{
+  printf("FlatMap lookups, 1M random queries with half hits (ns per lookup):\n");
+  printf("  %-8s %-10s %10s %10s\n", "key", "count", "classic", "FlatMap");
+
+  benchmarkSearchKeys<int64_t>("int64_t", benchmarkLarge ? 6 : 5,
+    [](uint64_t const random) { return static_cast<int64_t>(random >> 1); });
+  benchmarkSearchKeys<String>("String", benchmarkLarge ? 5 : 4,
+    [](uint64_t const random) { return utility::uintToStr(random, 16); });
+
+  printf("\n");
+}
+
+// Value of 256 bytes, large enough for the keys to be far apart when stored next to values.
+struct BenchmarkPayload
+{
+  int64_t data[32];
+};
+
+// Prints lookup latency and one-by-one insert cost of FlatMap with the given storage.
+template <typename Storage>
+static void benchmarkStorageMaps(char const* const name)
+{
+  typedef FlatMap<int64_t, BenchmarkPayload, DefaultComparer<int64_t>, Allocator, Storage> PayloadMap;
+
+  int64_t const counts[] = {1000, 10000, 100000, 1000000};
+  int64_t const queryCount = 1000000;
+  int64_t const insertCount = 50000;
+
+  printf("  %-12s", name);
+
+  for (int64_t const count : counts)
+  {
+    Array<int64_t> keys, queries, misses;
+    benchmarkKeys(keys, count, 1);
+    benchmarkPick(queries, keys, queryCount, 2);
+    benchmarkKeys(misses, queryCount / 2, 3);
+
+    // Half of queries are replaced with keys that are most likely missing.
+    for (int64_t i = 0; i < misses.length(); ++i)
+      queries[i * 2] = misses[i];
+
+    PayloadMap map;
+    {
+      Array<typename PayloadMap::KeyValue> pairs;
+
+      for (int64_t const key : keys)
+        pairs.addp({key, BenchmarkPayload{{key}}});
+
+      if (!map.addRange(static_cast<Array<typename PayloadMap::KeyValue>&&>(pairs)))
+        map.pollute();
+    }
+
+    if (!map)
+      printf("Error! Could not build map of %lld keys.\n", static_cast<long long>(count));
+
+    printf(" %8.1f", benchmarkLookup(map, queries));
+  }
+
+  Array<int64_t> keys;
+  benchmarkKeys(keys, insertCount, 4);
+
+  PayloadMap map;
+  TickCount const start = timingTickCountNS();
+
+  for (int64_t const key : keys)
+    map.addp(key, BenchmarkPayload{{key}});
+
+  if (!map)
+    printf("Error! Could not insert into map.\n");
+
+  printf(" %10.1f\n", benchmarkElapsed(start, insertCount) / 1000.0);
+}
+
+// Compares FlatMap storing keys next to values against storing them in a separate array.
+static void benchmarkStorage()
+{
+  printf("FlatMap storage, int64_t keys and 256-byte values, lookup with 1M random queries and half hits (ns)\n");
+  printf("and random inserts one by one up to 50K entries (us per insert):\n");
+  printf("  %-12s %8s %8s %8s %8s %10s\n", "storage", "1K", "10K", "100K", "1M", "insert");
+
+  benchmarkStorageMaps<PairStorage<int64_t, BenchmarkPayload>>("PairStorage");
+  benchmarkStorageMaps<SplitStorage<int64_t, BenchmarkPayload>>("SplitStorage");
+
+  printf("\n");
+}
+
+// Compares sequential sorting against sorting on different numbers of threads.
+static void benchmarkParallelSort()
+{
+  int64_t const count = benchmarkLarge ? 100000000 : 10000000;
+
+  // Zero threads means one thread per processor.
+  int32_t const threadCounts[] = {1, 2, 4, 8, 0};
+
+  printf("Sorting %lld random int64_t, sort() vs parallelSort() (ms):\n", static_cast<long long>(count));
+
+  Array<int64_t> values;
+
+  benchmarkSortInput(values, count, 0);
+  TickCount start = timingTickCountNS();
+  values.sort();
+  printf("  %-27s %8.1f\n", "sort()", benchmarkElapsedMS(start));
+
+  for (int32_t const threads : threadCounts)
+  {
+    benchmarkSortInput(values, count, 0);
+    start = timingTickCountNS();
+    values.parallelSort(DefaultComparer<int64_t>(), threads);
+    double const time = benchmarkElapsedMS(start);
+
+    if (!values)
+    {
+      printf("Error! Could not allocate merge buffer.\n");
+      values.unpollute();
+    }
+
+    if (threads > 0)
+      printf("  parallelSort(), %2d threads %8.1f\n", static_cast<int>(threads), time);
+    else
+      printf("  %-27s %8.1f\n", "parallelSort(), processors", time);
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  benchmarkNames = argv + 1;
+  benchmarkNameCount = argc - 1;
+
+  for (int i = 0; i < benchmarkNameCount; ++i)
+    benchmarkLarge |= utility::sameText(benchmarkNames[i], "large");
+
+  if (benchmarkSelected("filestream"))
+    benchmarkFileStream();
+
+  if (benchmarkSelected("sort"))
+    benchmarkSort();
+
+  if (benchmarkSelected("hashmap"))
+    benchmarkHashMap();
+
+  if (benchmarkSelected("relocation"))
+    benchmarkRelocations();
+
+  if (benchmarkSelected("find"))
+    benchmarkFind();
+
+  if (benchmarkSelected("utf"))
+    benchmarkUnicode();
+
+  if (benchmarkSelected("arena"))
+    benchmarkArena();
+
+  if (benchmarkSelected("stringpool"))
+    benchmarkStringPool();
+
+  if (benchmarkSelected("split"))
+    benchmarkSplit();
+
+  if (benchmarkSelected("parse"))
+    benchmarkParse();
+
+  if (benchmarkSelected("scope"))
+    benchmarkResourceScope();
+
+  if (benchmarkSelected("format"))
+    benchmarkFormat();
+
+  if (benchmarkSelected("map"))
+    benchmarkMaps();
+
+  if (benchmarkSelected("search"))
+    benchmarkSearch();
+
+  if (benchmarkSelected("storage"))
+    benchmarkStorage();
+
+  if (benchmarkSelected("parallelsort"))
+    benchmarkParallelSort();
+
+  return 0;
+}
@@ -18,4 +18,6 @@
 #include "TinyTRL_Containers.h"
 #include "TinyTRL_Strings.h"
 #include "TinyTRL_Timing.h"
-#include "TinyTRL_Streams.h"
\ No newline at end of file
+#include "TinyTRL_Streams.h"
+#include "TinyTRL_Profiler.h"
+#include "TinyTRL_StringPool.h"
\ No newline at end of file
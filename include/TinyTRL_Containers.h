@@ -16,6 +16,12 @@
 
 #include "TinyTRL_Math.h"
 
+#if defined(__PLATFORM_SSE2)
+  #include <emmintrin.h>
+#elif defined(__PLATFORM_NEON)
+  #include <arm_neon.h>
+#endif
+
 namespace trl {
 
 // Helper utilities.
@@ -26,6 +32,15 @@ namespace utility {
 template <typename Element>
 constexpr void swap(Element& element1, Element& element2);
 
+/// Tests whether elements of the given type can be moved to a different memory location by copying their
+/// bytes, without calling move constructor and destructor. This is true for all trivially copyable types,
+/// while other types that do not keep pointers to themselves may opt in by specializing this template.
+template <typename Element>
+struct TriviallyRelocatable
+{
+  static bool constexpr const value = __is_trivially_copyable(Element);
+};
+
 } // namespace utility
 
 /// Default allocator utility.
@@ -51,6 +66,243 @@ struct CAllocator
     size_t alignment) noexcept;
 };
 
+/// Statistics of the memory pool used by PoolAllocator.
+struct PoolStatistics
+{
+  /// Number of blocks that have been allocated from the pool.
+  uint64_t allocations;
+
+  /// Number of blocks that have been returned to the pool.
+  uint64_t releases;
+
+  /// Number of allocations that were too large for the pool and have been passed to operator new.
+  uint64_t largeAllocations;
+
+  /// Number of bytes that the pool has requested from operator new for its blocks.
+  uint64_t reservedBytes;
+
+  /// Number of free blocks that are kept in the shared depot.
+  uint64_t depotBlocks;
+};
+
+/// Allocator utility that serves blocks of up to MaxBlockSize bytes from power-of-two size classes, while
+/// larger blocks are passed to operator new. Each thread keeps a cache of free blocks for every size class,
+/// which exchanges blocks in batches with a shared depot, so that most allocations do not touch any shared
+/// state. Memory of the pool is never returned to the system, but is reused by all threads.
+struct PoolAllocator
+{
+  /// Size of the largest block in bytes that is served from the pool.
+  static size_t constexpr const MaxBlockSize = 32768;
+
+  /// Allocates requested number of bytes and returns pointer to the start of allocated memory block.
+  /// In case of memory allocation failure, NULL is returned.
+  [[nodiscard]] void* alloc(size_t numBytes, size_t alignment) noexcept;
+
+  /// Releases memory previously allocated with \c alloc(). The number of bytes and alignment must match
+  /// the values given during allocation.
+  void free(void* data, size_t numBytes, size_t alignment) noexcept;
+
+  /// Returns statistics of the pool. Counters of running threads are included up to their latest
+  /// exchange of blocks with the shared depot.
+  static PoolStatistics statistics() noexcept;
+};
+
+/// Allocator utility that never provides any memory. This can be used as an upstream allocator of
+/// MonotonicArena, which then never grows beyond its initial buffer.
+struct NullAllocator
+{
+  /// Always returns NULL.
+  [[nodiscard]] void* alloc(size_t numBytes, size_t alignment) noexcept;
+
+  /// Does nothing, as no memory is ever allocated.
+  void free(void* data, size_t numBytes, size_t alignment) noexcept;
+};
+
+/// Memory resource that allocates by advancing a pointer through a series of chunks, which are requested
+/// from the upstream allocator. Individual allocations are not released until the arena is reset, which
+/// makes it suitable for short-lived data such as that created while processing a single request.
+/// The arena is not thread-safe; containers access it through ArenaAllocator.
+template <typename Upstream = Allocator>
+class MonotonicArena
+{
+public:
+  /// Default size of the first chunk in bytes.
+  static size_t constexpr const DefaultChunkSize = 64 * 1024;
+
+  /// Creates an arena that requests chunks starting with the given size, which doubles with each chunk.
+  explicit MonotonicArena(size_t chunkSize = DefaultChunkSize, Upstream&& upstream = Upstream()) noexcept;
+
+  /// Creates an arena that allocates from the given buffer first and only then requests chunks from the
+  /// upstream allocator. The buffer is not owned by the arena and must outlive it.
+  MonotonicArena(void* buffer, size_t bufferSize, size_t chunkSize = DefaultChunkSize,
+    Upstream&& upstream = Upstream()) noexcept;
+
+  /// Releases all chunks back to the upstream allocator.
+  ~MonotonicArena();
+
+  /// Copy (and move) constructor is not allowed.
+  MonotonicArena(MonotonicArena const&) = delete;
+
+  /// Copy (and move) assignment operator is not allowed.
+  MonotonicArena& operator = (MonotonicArena const&) = delete;
+
+  /// Allocates requested number of bytes with the given alignment, which must be a power of two.
+  /// In case of memory allocation failure, NULL is returned.
+  [[nodiscard]] void* alloc(size_t numBytes, size_t alignment) noexcept;
+
+  /// Releases memory previously allocated with \c alloc(). This only has an effect when the given block is
+  /// the most recent allocation, which is then reused; otherwise the memory stays in use until reset.
+  void free(void* data, size_t numBytes, size_t alignment) noexcept;
+
+  /// Makes all memory of the arena available again, keeping the chunks for subsequent allocations.
+  /// Any objects that have been allocated from the arena must no longer be used.
+  void reset() noexcept;
+
+  /// Releases all chunks back to the upstream allocator and makes the initial buffer (if any) available again.
+  /// Any objects that have been allocated from the arena must no longer be used.
+  void release() noexcept;
+
+private:
+  // Header that precedes the memory of every chunk.
+  struct Chunk
+  {
+    // Next chunk in the list.
+    Chunk* next;
+
+    // Chunk size in bytes, including the header.
+    size_t size;
+  };
+
+  // Requests memory from the next chunk, allocating a new one if needed.
+  void* allocChunk(size_t numBytes, size_t alignment) noexcept;
+
+  // Aligns position within the current chunk and returns it, or NULL if the requested bytes do not fit.
+  void* allocHead(size_t numBytes, size_t alignment) noexcept;
+
+  // Initial buffer.
+  uint8_t* _buffer;
+  size_t _bufferSize;
+
+  // All chunks that have been requested from the upstream allocator.
+  Chunk* _chunks;
+
+  // Chunk that is currently used for allocations, or NULL when the initial buffer is used.
+  Chunk* _chunk;
+
+  // Current position and end of the memory that is used for allocations.
+  uint8_t* _head;
+  uint8_t* _end;
+
+  // Size in bytes of the next chunk that will be requested.
+  size_t _chunkSize;
+
+  Upstream _upstream;
+};
+
+/// Allocator that takes memory from MonotonicArena. It only keeps a reference to the arena, so it can be
+/// copied along with the containers that use it, while the arena must outlive all such containers.
+/// Example:
+/// \code
+///   MonotonicArena<> arena;
+///   Array<int, ArenaAllocator<>> values(ArenaAllocator<>(arena));
+/// \endcode
+template <typename Upstream = Allocator>
+class ArenaAllocator
+{
+public:
+  /// Creates allocator that takes memory from the given arena.
+  ArenaAllocator(MonotonicArena<Upstream>& arena) noexcept;
+
+  /// Allocates requested number of bytes from the arena.
+  [[nodiscard]] void* alloc(size_t numBytes, size_t alignment) noexcept;
+
+  /// Returns memory to the arena.
+  void free(void* data, size_t numBytes, size_t alignment) noexcept;
+
+private:
+  // Arena from which the memory is allocated.
+  MonotonicArena<Upstream>* _arena;
+};
+
+/// Allocator interface that can be selected at runtime, which is used by strings and memory streams.
+class MemoryResource
+{
+public:
+  /// Releases the resource.
+  virtual ~MemoryResource();
+
+  /// Allocates requested number of bytes and returns pointer to the start of allocated memory block.
+  /// In case of memory allocation failure, NULL is returned.
+  [[nodiscard]] virtual void* alloc(size_t numBytes, size_t alignment) noexcept = 0;
+
+  /// Releases memory previously allocated with \c alloc(). The number of bytes and alignment must match
+  /// the values given during allocation.
+  virtual void free(void* data, size_t numBytes, size_t alignment) noexcept = 0;
+
+  /// Allocates requested number of bytes, or reallocates a previously allocated memory block to a new
+  /// length, preserving existing contents. If "requestedBytes" is zero, releases an existing memory and
+  /// returns NULL. In case of memory allocation failure, returns NULL and keeps the existing memory.
+  /// Default implementation allocates a new block, copies the contents and releases the previous block.
+  [[nodiscard]] virtual void* reallocate(void* data, size_t dataBytes, size_t requestedBytes,
+    size_t alignment) noexcept;
+};
+
+/// Memory resource that passes all requests to an allocator utility, such as ArenaAllocator or PoolAllocator.
+template <typename Alloc>
+class AllocatorResource : public MemoryResource
+{
+public:
+  /// Creates a resource with the given allocator.
+  AllocatorResource(Alloc&& alloc = Alloc()) noexcept;
+
+  /// Allocates requested number of bytes using the allocator.
+  [[nodiscard]] void* alloc(size_t numBytes, size_t alignment) noexcept override;
+
+  /// Releases memory using the allocator.
+  void free(void* data, size_t numBytes, size_t alignment) noexcept override;
+
+private:
+  // Allocator utility.
+  Alloc _alloc;
+};
+
+/// Scope during which the memory of long strings and memory streams created on the current thread is
+/// allocated from the given resource. Such strings and streams keep using the resource that has allocated
+/// them after the scope ends, so they must be destroyed before the resource itself (or before an arena
+/// behind the resource is reset). Scopes can be nested, while a NULL resource selects C heap functions.
+/// Example:
+/// \code
+///   MonotonicArena<> arena;
+///   AllocatorResource<ArenaAllocator<>> resource(arena);
+///   {
+///     ResourceScope scope(&resource);
+///     // ... work with request-scoped strings ...
+///   }
+///   arena.reset();
+/// \endcode
+class ResourceScope
+{
+public:
+  /// Makes the given resource current on this thread.
+  explicit ResourceScope(MemoryResource* resource) noexcept;
+
+  /// Restores the resource that was current before this scope.
+  ~ResourceScope();
+
+  /// Copy (and move) constructor is not allowed.
+  ResourceScope(ResourceScope const&) = delete;
+
+  /// Copy (and move) assignment operator is not allowed.
+  ResourceScope& operator = (ResourceScope const&) = delete;
+
+  /// Returns the resource of the innermost scope on this thread, or NULL if there is none.
+  [[nodiscard]] static MemoryResource* current() noexcept;
+
+private:
+  // Resource that was current before this scope.
+  MemoryResource* _previous;
+};
+
 /// Common container types and constants.
 class Containers
 {
@@ -72,6 +324,18 @@ public:
   /// Special constant to denote an invalid or inexistent index.
   static Length constexpr const NotFound = -1;
 
+  /// Policy for resolving duplicate keys when adding multiple elements at once.
+  enum class Duplicates : uint8_t
+  {
+    /// The earliest occurrence is kept: existing elements take precedence over added ones, and among added
+    /// elements the one that comes first is used.
+    KeepFirst,
+
+    /// The latest occurrence is kept: added elements replace existing ones, and among added elements the one
+    /// that comes last is used.
+    KeepLast
+  };
+
   /// Key-value pair combination.
   template <typename Key, typename Value>
   struct Pair
@@ -191,6 +455,107 @@ protected:
 
   /// Calculates next exponentially-growing buffer capacity.
   static Length computeCapacity(Length targetCapacity, Length currentCapacity) noexcept;
+
+  /// Maximal number of threads that run parts of a parallel task.
+  static int32_t constexpr const MaxParallelThreads = 256;
+
+  /// Function that performs one part of a parallel task, receiving shared context and index of the part.
+  typedef void (*ParallelTask)(void* context, int32_t index);
+
+  /// Returns number of processors that are available to the process.
+  static int32_t processorCount() noexcept;
+
+  /// Runs each part of a task below the given count on its own native thread and waits until all of them
+  /// finish. The first part is run on the calling thread, as is any part, for which a thread could not be
+  /// created.
+  static void runParallel(ParallelTask task, void* context, int32_t count) noexcept;
+
+  /// Number of remaining elements, at which searching sorted elements switches from halving the range to a
+  /// linear scan.
+  static Length constexpr const SearchLinearLength = 8;
+
+  /// Hints the processor to start loading memory at the given address into the cache.
+  static void prefetch(void const* address) noexcept;
+
+  /// Searches sorted elements for the first one that is not less than the given value, where the comparer
+  /// returns result of three-way comparison between an element and the value. For trivially copyable values,
+  /// each step halves the range without branching, while both elements that the next step may examine are
+  /// prefetched, and the last few elements are counted in a linear scan. Returns true if the element at the
+  /// resulting index matches the value.
+  template <typename Element, typename SearchValue, typename Compare>
+  static bool searchSorted(Length& index, Element const* elements, Length count, SearchValue const& value,
+    Compare const& compare) noexcept;
+
+  /// Control byte that describes the state of a hash table slot. Occupied slots store 7 bits of the
+  /// element's hash, while free slots use negative values.
+  typedef int8_t Control;
+
+  /// Control byte of a slot that has never been occupied.
+  static Control constexpr const ControlEmpty = -128;
+
+  /// Control byte of a slot whose element has been erased.
+  static Control constexpr const ControlDeleted = -2;
+
+  /// Number of control bytes that are examined together when probing a hash table.
+  static Length constexpr const GroupWidth = 16;
+
+  /// Set of matching slots within a group of control bytes.
+  class ControlMask
+  {
+  public:
+    /// Creates a set from the given match bits.
+    explicit constexpr ControlMask(uint64_t bits);
+
+    /// Tests whether there are any matching slots in the set.
+    explicit constexpr operator bool () const;
+
+    /// Returns position of the first matching slot within the group.
+    int32_t lowest() const noexcept;
+
+    /// Returns number of consecutive non-matching slots at the end of the group.
+    int32_t leadingZeros() const noexcept;
+
+    /// Removes the first matching slot from the set.
+    void next() noexcept;
+
+  private:
+    // Number of bits used to represent a single control byte (as a power of two).
+#ifdef __PLATFORM_NEON
+    static int32_t constexpr const Shift = 2;
+#else
+    static int32_t constexpr const Shift = 0;
+#endif
+
+    // Match bits.
+    uint64_t _bits;
+  };
+
+  /// Group of consecutive control bytes that are matched in parallel.
+  class ControlGroup
+  {
+  public:
+    /// Loads a group of control bytes starting at the given address.
+    explicit ControlGroup(Control const* controls) noexcept;
+
+    /// Returns a set of occupied slots whose hash bits match the given ones.
+    ControlMask match(Control hash) const noexcept;
+
+    /// Returns a set of slots that have never been occupied.
+    ControlMask matchEmpty() const noexcept;
+
+    /// Returns a set of slots that are not occupied.
+    ControlMask matchEmptyOrDeleted() const noexcept;
+
+  private:
+    // Loaded control bytes.
+#if defined(__PLATFORM_SSE2)
+    __m128i _controls;
+#elif defined(__PLATFORM_NEON)
+    int8x16_t _controls;
+#else
+    Control _controls[GroupWidth];
+#endif
+  };
 };
 
 /// Three-way comparison helper for two generic arguments.
@@ -209,6 +574,28 @@ struct DefaultComparer
   constexpr int8_t operator () (Value const& left, Value const& right) const;
 };
 
+/// Hashing helper for generic arguments.
+struct DefaultHash
+{
+  /// Computes hash from the binary representation of a value. This is suitable for integers, pointers and
+  /// plain structures without padding, while other types (e.g. floating-point numbers and padded structures)
+  /// fail to compile, since their equal values may differ in binary representation.
+  template <typename Value>
+  static size_t perform(Value const& value);
+};
+
+/// Hashing functor template for generic arguments. Strings provide their own specializations, which hash
+/// characters instead of binary representation.
+template <typename Value>
+struct DefaultHasher
+{
+  /// Computes hash of the given value.
+  size_t operator () (Value const& value) const;
+
+  /// Tests whether left parameter is equal to right parameter.
+  bool operator () (Value const& left, Value const& right) const;
+};
+
 /// Dynamic array that provides an exponentially growing capacity.
 template <typename Element, typename Alloc = Allocator>
 class Array : public Containers
@@ -289,6 +676,9 @@ public:
   /// error during memory allocation or some data corruption.
   [[nodiscard]] explicit operator bool () const noexcept;
 
+  /// Returns constant reference to custom allocator module, which can be copied to allocate related memory.
+  [[nodiscard]] Alloc const& allocator() const noexcept;
+
   /// Returns number of elements that array can hold before realloacating to a greater length.
   [[nodiscard]] Length capacity() const noexcept;
 
@@ -314,6 +704,13 @@ public:
   /// Adds multiple elements to the array with the same value.
   [[nodiscard]] bool populate(Length count, Element const& value);
 
+  /// Adds the given number of elements to the array, which are constructed in place by the given function.
+  /// The function receives pointer to uninitialized memory of new elements and must construct all of them,
+  /// while it may also rearrange existing elements, e.g. to merge new elements between them. In case of an
+  /// overflow or a memory allocation failure, returns false without calling the function.
+  template <typename ElementsConstruct>
+  [[nodiscard]] bool expand(Length count, ElementsConstruct const& elementsConstruct);
+
   /// Adds a copy of the given element to the array, returning its index.
   /// In case of an overflow or a memory allocation failure, returns NotFound.
   [[nodiscard]] Length add(Element const& element);
@@ -368,6 +765,20 @@ public:
   template <typename Comparer = DefaultComparer<Element>>
   void quickSort(Length first = 0, Length last = MaxLength, Comparer const& comparer = Comparer());
 
+  /// Sorts a range of elements in ascending order using IntroSort algorithm, which guarantees O(n log n)
+  /// running time and logarithmic stack depth regardless of input, and handles duplicates efficiently.
+  template <typename Comparer = DefaultComparer<Element>>
+  void sort(Length first = 0, Length last = MaxLength, Comparer const& comparer = Comparer());
+
+  /// Sorts all elements in ascending order on the given number of threads, or one thread per processor if
+  /// the number is zero. The array is split into chunks, which are sorted concurrently as in \c sort(), and
+  /// then merged in rounds, where each merge is split between threads as well, so the comparer must be safe
+  /// to call concurrently. Arrays that are too small to benefit from threads are sorted sequentially. In case
+  /// of a memory allocation failure for the merge buffer, sorts elements sequentially and pollutes the array
+  /// (sets an error bit).
+  template <typename Comparer = DefaultComparer<Element>>
+  void parallelSort(Comparer const& comparer = Comparer(), int32_t threads = 0);
+
   /// Searches for a given element using Binary Search algorithm.
   /// The elements in the array must be sorted in ascending order for this function to work.
   template <typename Comparer = DefaultComparer<Element>>
@@ -400,6 +811,110 @@ private:
   template <typename Comparer>
   Length partitionQuickSort(Length first, Length last, Comparer const& comparer);
 
+  // Ranges of this size or smaller are sorted using Insertion Sort.
+  static Length constexpr const InsertionSortThreshold = 16;
+
+  // Ranges bigger than this use pseudo-median of nine elements as pivot instead of median of three.
+  static Length constexpr const NintherThreshold = 128;
+
+  // Sorts elements within the given range using IntroSort algorithm, falling back to HeapSort after
+  // reaching the depth limit. Unless the range is leftmost, the element preceding it must not be greater
+  // than any element in the range.
+  template <typename Comparer>
+  void introSort(Length first, Length last, Length depthLimit, bool leftmost, Comparer const& comparer);
+
+  // Moves the chosen pivot for IntroSort to the first position of the range.
+  template <typename Comparer>
+  void selectPivot(Length first, Length last, Comparer const& comparer);
+
+  // Orders three elements with the given indices between themselves.
+  template <typename Comparer>
+  void sortThree(Length first, Length second, Length third, Comparer const& comparer);
+
+  // Returns index of the median of three elements with the given indices.
+  template <typename Comparer>
+  Length medianOfThree(Length first, Length second, Length third, Comparer const& comparer);
+
+  // Performs Hoare partitioning around pivot located at the first position, returning its final position.
+  // Elements equal to pivot may end up on either side.
+  template <typename Comparer>
+  Length partitionTwoWay(Length first, Length last, Comparer const& comparer);
+
+  // Performs three-way partitioning around pivot located at the first position, returning the range of
+  // elements that are equal to pivot.
+  template <typename Comparer>
+  void partitionThreeWay(Length first, Length last, Length& lower, Length& upper, Comparer const& comparer);
+
+  // Sorts elements within the given range using Insertion Sort algorithm.
+  template <typename Comparer>
+  void insertionSort(Length first, Length last, Comparer const& comparer);
+
+  // Sorts elements within the given range using HeapSort algorithm.
+  template <typename Comparer>
+  void heapSort(Length first, Length last, Comparer const& comparer);
+
+  // Minimal number of elements for each thread of parallel sorting, below which threads do not pay off.
+  static Length constexpr const ParallelSortMinLength = 32768;
+
+  // State of parallel sorting that is shared between threads.
+  template <typename Comparer>
+  struct ParallelSort
+  {
+    // Array that is being sorted.
+    Array* array;
+
+    // Comparer module.
+    Comparer const* comparer;
+
+    // Elements of sorted runs, which are either those of the array, or those of the merge buffer.
+    Element* source;
+
+    // Uninitialized memory, where merged runs are placed.
+    Element* dest;
+
+    // Number of threads.
+    int32_t threads;
+
+    // Number of sorted runs.
+    int32_t runs;
+
+    // Number of segments, into which each merge of the current round is split.
+    int32_t segments;
+
+    // Starting indices of sorted runs, followed by the number of elements.
+    Length bounds[MaxParallelThreads + 1];
+
+    // Number of elements from the left run that precede each segment of the current round's merges.
+    Length splits[MaxParallelThreads];
+  };
+
+  // Sorts a chunk of elements with the given index during parallel sorting.
+  template <typename Comparer>
+  static void parallelSortChunk(void* context, int32_t index);
+
+  // Splits each merge of the current round into segments during parallel sorting. This is done before any
+  // elements are moved, as finding a split reads elements of both runs.
+  template <typename Comparer>
+  static void parallelSplit(ParallelSort<Comparer>& state);
+
+  // Performs share of the current merge round for a thread with the given index during parallel sorting.
+  template <typename Comparer>
+  static void parallelMerge(void* context, int32_t index);
+
+  // Moves share of merged elements to their final place for a thread with the given index.
+  template <typename Comparer>
+  static void parallelMove(void* context, int32_t index);
+
+  // Returns how many of the given number of smallest elements of two sorted runs come from the left run,
+  // where elements of the left run precede equal elements of the right run.
+  template <typename Comparer>
+  static Length mergeSplit(Element const* left, Length leftLength, Element const* right, Length rightLength,
+    Length count, Comparer const& comparer);
+
+  // Restores heap property for HeapSort algorithm starting at the given root.
+  template <typename Comparer>
+  void siftDown(Length first, Length root, Length count, Comparer const& comparer);
+
   // Inserts an element to the requested position in the array.
   template <typename ElementAssign>
   bool elementInsert(Length index, ElementAssign const& elementAssign);
@@ -414,6 +929,10 @@ private:
   // Calls destructors for all elements in reverse order and releases allocated memory.
   void deallocate();
 
+  // Moves elements to a new memory location, which may overlap with the source, leaving source memory
+  // uninitialized. Trivially relocatable elements are moved with a single bulk copy.
+  static void relocate(Element* dest, Element* source, Length count) noexcept;
+
   // Allocates a given number of elements using custom allocator.
   Element* alloc(Length count);
 
@@ -421,93 +940,319 @@ private:
   void free(Element* data, Length count);
 };
 
-/// Associative container between key and value pairs using a sorted array for storage.
-template <typename Key, typename Value, typename Comparer = DefaultComparer<Key>, typename Alloc = Allocator>
-class FlatMap : public Containers
+/// Storage module of FlatMap that keeps each key together with its value in a single array of pairs. This
+/// suits small values and enables iterating over pairs.
+template <typename Key, typename Value, typename Alloc = Allocator>
+class PairStorage : public Containers
 {
 public:
   /// Pair that represents both key and value.
   typedef Pair<Key, Value> KeyValue;
 
-  /// Creates an empty container.
-  FlatMap(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
-
-  /// Creates container from an initializer list.
-  FlatMap(std::initializer_list<KeyValue> pairs, Comparer&& comparer = Comparer(),
-    Alloc&& alloc = Alloc()) noexcept;
-
-  /// Creates a new container copying elements from an existing container.
-  /// In case of a memory allocation failure, creates an empty polluted map (with an error bit set).
-  FlatMap(FlatMap const&) = default;
-
-  /// Creates a new container with contents moved from another container.
-  FlatMap(FlatMap&&) noexcept = default;
-
-  /// Copies the contents of source container into this one.
-  /// In case of a memory allocation failure, pollutes current container (sets an error bit).
-  FlatMap& operator = (FlatMap const&) = default;
-
-  /// Moves contents of another container into this one.
-  FlatMap& operator = (FlatMap&&) noexcept = default;
-
-  /// Provides index-based access to the container.
-  [[nodiscard]] KeyValue const& operator [] (Location const& location) const noexcept;
-
-  /// Returns constant pointer to the first pair in the container.
-  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
-  KeyValue const* begin() const noexcept;
-
-  /// Returns constant pointer to one pair past last in the container.
-  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
-  KeyValue const* end() const noexcept;
+  /// Creates an empty storage.
+  explicit PairStorage(Alloc&& alloc = Alloc()) noexcept;
 
-  /// Returns constant reference to first key/value pair in the list.
-  [[nodiscard]] KeyValue const& first() const noexcept;
+  /// Returns constant pointer to the first pair.
+  [[nodiscard]] KeyValue const* data() const noexcept;
 
-  /// Returns constant reference to last key/value pair in the list.
-  [[nodiscard]] KeyValue const& last() const noexcept;
+  /// Returns pointer to the first pair.
+  [[nodiscard]] KeyValue* data() noexcept;
 
-  /// Tests whether a container is not polluted. A polluted buffer has an error bit set. This may indicate
-  /// an error during memory allocation or some data corruption.
+  /// Tests whether a storage is not polluted.
   [[nodiscard]] explicit operator bool () const noexcept;
 
-  /// Returns number of elements that container can hold before realloacating to a greater length.
+  /// Returns constant reference to custom allocator module.
+  [[nodiscard]] Alloc const& allocator() const noexcept;
+
+  /// Returns number of pairs that storage can hold before reallocating.
   [[nodiscard]] Length capacity() const noexcept;
 
-  /// Increases container capacity to accomodate at least the requested number of elements.
+  /// Increases storage capacity to accomodate at least the requested number of pairs.
   [[nodiscard]] bool capacity(Length capacity);
 
-  /// Returns number of elements in the container.
+  /// Returns number of pairs.
   [[nodiscard]] Length length() const noexcept;
 
-  /// Clears container by removing all elements but without releasing pre-allocated memory.
+  /// Adds the given number of pairs at the end, calling the given function once memory has been reserved.
+  /// The function must construct all new pairs with \c construct() or \c moveConstruct(), and may rearrange
+  /// existing pairs. In case of an overflow or a memory allocation failure, returns false.
+  template <typename PairsConstruct>
+  [[nodiscard]] bool expand(Length count, PairsConstruct const& pairsConstruct);
+
+  /// Removes all pairs but without releasing pre-allocated memory.
   void clear() noexcept;
 
-  /// Shrinks container so that its capacity will match actual stored number of elements.
+  /// Shrinks storage so that its capacity will match actual stored number of pairs.
   [[nodiscard]] bool shrink() noexcept;
 
-  /// Clears the container and releases any pre-allocated memory.
+  /// Removes all pairs and releases any pre-allocated memory.
   void purge() noexcept;
 
-  /// Tests whether a given key is already in the list.
-  [[nodiscard]] bool exists(Key const& key) const noexcept;
+  /// Tests whether the storage is empty.
+  [[nodiscard]] bool empty() const noexcept;
 
-  /// Adds or updates a key/value pair to the container, returning its location.
-  [[nodiscard]] Location add(Key const& key, Value const& value);
+  /// Sets an error bit in the storage, marking it as polluted.
+  void pollute() noexcept;
 
-  /// Adds or updates a key and (moved in) value pair to the container, returning its location.
-  [[nodiscard]] Location add(Key const& key, Value&& value);
+  /// Resets error bit in the storage, removing pollute status.
+  void unpollute() noexcept;
 
-  /// Adds or updates a (moved in) key and value pair to the container, returning its location.
-  [[nodiscard]] Location add(Key&& key, Value const& value);
+  /// Returns constant reference to key at the given index.
+  [[nodiscard]] Key const& key(Length index) const noexcept;
 
-  /// Adds or updates a moved in key/value pair to the container, returning its location.
-  [[nodiscard]] Location add(Key&& key, Value&& value);
+  /// Returns constant reference to value at the given index.
+  [[nodiscard]] Value const& value(Length index) const noexcept;
 
-  /// Inserts a given pair of key/value at the given location returned by \c find() function.
-  /// Warning: only location returned by a recent call of \c find() is allowed. Inserting elements at other
-  /// locations may make the list loose its ordered property and cause undefined behavior.
-  [[nodiscard]] bool insert(Location const& location, Key const& key, Value const& value);
+  /// Returns reference to value at the given index.
+  [[nodiscard]] Value& value(Length index) noexcept;
+
+  /// Inserts key and value at the given index, forwarding them to pair's constructor.
+  template <typename KeyType, typename ValueType>
+  [[nodiscard]] bool insert(Length index, KeyType&& key, ValueType&& value);
+
+  /// Removes pair at the given index.
+  bool erase(Length index) noexcept;
+
+  /// Moves pair from the source index to the destination index.
+  void move(Length dest, Length source) noexcept;
+
+  /// Assigns pair at the given index from another pair, which is moved in unless it is constant.
+  template <typename Source>
+  void assign(Length index, Source&& pair);
+
+  /// Moves pair from the source index into uninitialized memory at the destination index.
+  void moveConstruct(Length dest, Length source) noexcept;
+
+  /// Constructs pair in uninitialized memory at the given index from another pair, which is moved in unless
+  /// it is constant.
+  template <typename Source>
+  void construct(Length index, Source&& pair);
+
+  /// Searches sorted pairs for a given key (see \c Containers::searchSorted()).
+  template <typename Comparer>
+  [[nodiscard]] bool search(Length& index, Key const& key, Comparer const& comparer) const noexcept;
+
+private:
+  // Compares key of a pair with the given key using comparer module.
+  template <typename Comparer>
+  struct PairComparer
+  {
+    // Comparer module of the container.
+    Comparer const& comparer;
+
+    // Performs three-way comparison between key of the pair and the given key.
+    auto operator () (KeyValue const& pair, Key const& key) const;
+  };
+
+  // Integrated array of key/value pairs.
+  Array<KeyValue, Alloc> _pairs;
+};
+
+/// Storage module of FlatMap that keeps keys and values in separate parallel arrays, so that searching
+/// touches only the keys. This suits big values, which would otherwise be loaded into cache together with
+/// each probed key. Pairs are not stored as such, so the container cannot be iterated over pairs, but keys
+/// and values are still accessible by location.
+template <typename Key, typename Value, typename Alloc = Allocator>
+class SplitStorage : public Containers
+{
+public:
+  /// Creates an empty storage.
+  explicit SplitStorage(Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates a new storage copying keys and values from an existing one.
+  /// In case of a memory allocation failure, creates an empty polluted storage (with an error bit set).
+  SplitStorage(SplitStorage const& storage);
+
+  /// Creates a new storage with contents moved from another one.
+  SplitStorage(SplitStorage&&) noexcept = default;
+
+  /// Copies keys and values of source storage into this one.
+  /// In case of a memory allocation failure, clears and pollutes current storage (sets an error bit).
+  SplitStorage& operator = (SplitStorage const& storage);
+
+  /// Moves contents of another storage into this one.
+  SplitStorage& operator = (SplitStorage&&) noexcept = default;
+
+  /// Tests whether a storage is not polluted.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Returns constant reference to custom allocator module.
+  [[nodiscard]] Alloc const& allocator() const noexcept;
+
+  /// Returns number of pairs that storage can hold before reallocating.
+  [[nodiscard]] Length capacity() const noexcept;
+
+  /// Increases storage capacity to accomodate at least the requested number of pairs.
+  [[nodiscard]] bool capacity(Length capacity);
+
+  /// Returns number of pairs.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Adds the given number of pairs at the end, calling the given function once memory has been reserved.
+  /// The function must construct all new pairs with \c construct() or \c moveConstruct(), and may rearrange
+  /// existing pairs. In case of an overflow or a memory allocation failure, returns false.
+  template <typename PairsConstruct>
+  [[nodiscard]] bool expand(Length count, PairsConstruct const& pairsConstruct);
+
+  /// Removes all pairs but without releasing pre-allocated memory.
+  void clear() noexcept;
+
+  /// Shrinks storage so that its capacity will match actual stored number of pairs.
+  [[nodiscard]] bool shrink() noexcept;
+
+  /// Removes all pairs and releases any pre-allocated memory.
+  void purge() noexcept;
+
+  /// Tests whether the storage is empty.
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Sets an error bit in the storage, marking it as polluted.
+  void pollute() noexcept;
+
+  /// Resets error bit in the storage, removing pollute status.
+  void unpollute() noexcept;
+
+  /// Returns constant reference to key at the given index.
+  [[nodiscard]] Key const& key(Length index) const noexcept;
+
+  /// Returns constant reference to value at the given index.
+  [[nodiscard]] Value const& value(Length index) const noexcept;
+
+  /// Returns reference to value at the given index.
+  [[nodiscard]] Value& value(Length index) noexcept;
+
+  /// Inserts key and value at the given index, forwarding them to constructors. Either both are inserted, or
+  /// neither of them.
+  template <typename KeyType, typename ValueType>
+  [[nodiscard]] bool insert(Length index, KeyType&& key, ValueType&& value);
+
+  /// Removes key and value at the given index.
+  bool erase(Length index) noexcept;
+
+  /// Moves key and value from the source index to the destination index.
+  void move(Length dest, Length source) noexcept;
+
+  /// Assigns key and value at the given index from a pair, which is moved in unless it is constant.
+  template <typename Source>
+  void assign(Length index, Source&& pair);
+
+  /// Moves key and value from the source index into uninitialized memory at the destination index.
+  void moveConstruct(Length dest, Length source) noexcept;
+
+  /// Constructs key and value in uninitialized memory at the given index from a pair, which is moved in unless
+  /// it is constant.
+  template <typename Source>
+  void construct(Length index, Source&& pair);
+
+  /// Searches sorted keys for a given key (see \c Containers::searchSorted()).
+  template <typename Comparer>
+  [[nodiscard]] bool search(Length& index, Key const& key, Comparer const& comparer) const noexcept;
+
+private:
+  // Array of keys.
+  Array<Key, Alloc> _keys;
+
+  // Array of values in the same order as keys.
+  Array<Value, Alloc> _values;
+};
+
+/// Associative container between key and value pairs using a sorted array for storage. Storage module
+/// decides whether pairs are kept together (see PairStorage) or keys are separated from values (see
+/// SplitStorage). Functions that access whole pairs are only available with PairStorage.
+template <typename Key, typename Value, typename Comparer = DefaultComparer<Key>, typename Alloc = Allocator,
+  typename Storage = PairStorage<Key, Value, Alloc>>
+class FlatMap : public Containers
+{
+public:
+  /// Pair that represents both key and value.
+  typedef Pair<Key, Value> KeyValue;
+
+  /// Creates an empty container.
+  FlatMap(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from an initializer list.
+  FlatMap(std::initializer_list<KeyValue> pairs, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from an array of key/value pairs, which do not need to be sorted. Duplicate keys are
+  /// resolved by keeping the last pair. In case of a memory allocation failure, creates an empty polluted
+  /// map (with an error bit set).
+  template <typename ArrayAlloc>
+  explicit FlatMap(Array<KeyValue, ArrayAlloc> const& pairs, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates a new container copying elements from an existing container.
+  /// In case of a memory allocation failure, creates an empty polluted map (with an error bit set).
+  FlatMap(FlatMap const&) = default;
+
+  /// Creates a new container with contents moved from another container.
+  FlatMap(FlatMap&&) noexcept = default;
+
+  /// Copies the contents of source container into this one.
+  /// In case of a memory allocation failure, pollutes current container (sets an error bit).
+  FlatMap& operator = (FlatMap const&) = default;
+
+  /// Moves contents of another container into this one.
+  FlatMap& operator = (FlatMap&&) noexcept = default;
+
+  /// Provides index-based access to the container.
+  [[nodiscard]] KeyValue const& operator [] (Location const& location) const noexcept;
+
+  /// Returns constant pointer to the first pair in the container.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  KeyValue const* begin() const noexcept;
+
+  /// Returns constant pointer to one pair past last in the container.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  KeyValue const* end() const noexcept;
+
+  /// Returns constant reference to first key/value pair in the list.
+  [[nodiscard]] KeyValue const& first() const noexcept;
+
+  /// Returns constant reference to last key/value pair in the list.
+  [[nodiscard]] KeyValue const& last() const noexcept;
+
+  /// Tests whether a container is not polluted. A polluted buffer has an error bit set. This may indicate
+  /// an error during memory allocation or some data corruption.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Returns number of elements that container can hold before realloacating to a greater length.
+  [[nodiscard]] Length capacity() const noexcept;
+
+  /// Increases container capacity to accomodate at least the requested number of elements.
+  [[nodiscard]] bool capacity(Length capacity);
+
+  /// Returns number of elements in the container.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Clears container by removing all elements but without releasing pre-allocated memory.
+  void clear() noexcept;
+
+  /// Shrinks container so that its capacity will match actual stored number of elements.
+  [[nodiscard]] bool shrink() noexcept;
+
+  /// Clears the container and releases any pre-allocated memory.
+  void purge() noexcept;
+
+  /// Tests whether a given key is already in the list.
+  [[nodiscard]] bool exists(Key const& key) const noexcept;
+
+  /// Adds or updates a key/value pair to the container, returning its location.
+  [[nodiscard]] Location add(Key const& key, Value const& value);
+
+  /// Adds or updates a key and (moved in) value pair to the container, returning its location.
+  [[nodiscard]] Location add(Key const& key, Value&& value);
+
+  /// Adds or updates a (moved in) key and value pair to the container, returning its location.
+  [[nodiscard]] Location add(Key&& key, Value const& value);
+
+  /// Adds or updates a moved in key/value pair to the container, returning its location.
+  [[nodiscard]] Location add(Key&& key, Value&& value);
+
+  /// Inserts a given pair of key/value at the given location returned by \c find() function.
+  /// Warning: only location returned by a recent call of \c find() is allowed. Inserting elements at other
+  /// locations may make the list loose its ordered property and cause undefined behavior.
+  [[nodiscard]] bool insert(Location const& location, Key const& key, Value const& value);
 
   /// Inserts a given key and (moved in) value at the given location returned by \c find() function.
   /// Warning: only location returned by a recent call of \c find() is allowed. Inserting elements at other
@@ -540,6 +1285,25 @@ public:
   /// failure, sets an error bit, marking container as polluted.
   FlatMap& addp(Key&& key, Value&& value);
 
+  /// Adds or updates multiple key/value pairs, which do not need to be sorted. The pairs are sorted once and
+  /// merged with existing contents in a single pass, which is much faster than adding them one by one.
+  /// In case of an overflow or a memory allocation failure, returns false and leaves container unchanged.
+  [[nodiscard]] bool addRange(KeyValue const* pairs, Length count, Duplicates duplicates = Duplicates::KeepLast);
+
+  /// Adds or updates multiple key/value pairs from an initializer list (see \c addRange() above).
+  [[nodiscard]] bool addRange(std::initializer_list<KeyValue> pairs,
+    Duplicates duplicates = Duplicates::KeepLast);
+
+  /// Adds or updates multiple key/value pairs from an array (see \c addRange() above).
+  template <typename ArrayAlloc>
+  [[nodiscard]] bool addRange(Array<KeyValue, ArrayAlloc> const& pairs,
+    Duplicates duplicates = Duplicates::KeepLast);
+
+  /// Adds or updates multiple key/value pairs moved in from an array (see \c addRange() above). On success,
+  /// the source array is cleared.
+  template <typename ArrayAlloc>
+  [[nodiscard]] bool addRange(Array<KeyValue, ArrayAlloc>&& pairs, Duplicates duplicates = Duplicates::KeepLast);
+
   /// Erases value with the given key from the container, if such exists.
   bool erase(Key const& key) noexcept;
 
@@ -553,6 +1317,9 @@ public:
   /// Returns pointer to value associated with the given key. If such key is not found, returns NULL.
   [[nodiscard]] Value* value(Key const& key) noexcept;
 
+  /// Returns constant reference to key at the given location.
+  [[nodiscard]] Key const& key(Location const& location) const noexcept;
+
   /// Returns constant reference to value associated with the given location.
   [[nodiscard]] Value const& at(Location const& location) const noexcept;
 
@@ -576,17 +1343,23 @@ public:
   FlatMap& unpollute() noexcept;
 
 private:
-  // Container for integrated key/value pairs.
-  typedef Array<KeyValue, Alloc> KeyValues;
+  // Frozen container takes over pairs of a container that is moved into it.
+  template <typename, typename, typename, typename>
+  friend class FrozenFlatMap;
 
-  // Integrated array of key/value pairs.
-  KeyValues _pairs;
+  // Storage module with key/value pairs.
+  Storage _storage;
 
   // Comparer module.
   Comparer _comparer;
 
   // Attempts to find a given key using binary search.
   bool search(Length& index, Key const& key) const noexcept;
+
+  // Sorts, deduplicates and merges the given pairs with existing contents. Pairs are moved in unless the
+  // source type is constant.
+  template <typename Source>
+  bool mergeRange(Source* pairs, Length count, Duplicates duplicates);
 };
 
 /// A set of unique values using a sorted array for storage.
@@ -600,6 +1373,13 @@ public:
   /// Creates container from an initializer list.
   FlatSet(std::initializer_list<Value> values, Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc());
 
+  /// Creates container from an array of values, which do not need to be sorted. Duplicate values are
+  /// resolved by keeping the first one. In case of a memory allocation failure, creates an empty polluted
+  /// set (with an error bit set).
+  template <typename ArrayAlloc>
+  explicit FlatSet(Array<Value, ArrayAlloc> const& values, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc());
+
   /// Creates a new container copying elements from an existing container.
   /// In case of a memory allocation failure, creates an empty polluted map (with an error bit set).
   FlatSet(FlatSet const&) = default;
@@ -680,6 +1460,25 @@ public:
   /// bit, marking container as polluted.
   FlatSet& addp(Value&& value);
 
+  /// Adds multiple values, which do not need to be sorted. The values are sorted once and merged with
+  /// existing contents in a single pass, which is much faster than adding them one by one. In case of an
+  /// overflow or a memory allocation failure, returns false and leaves container unchanged.
+  [[nodiscard]] bool addRange(Value const* values, Length count, Duplicates duplicates = Duplicates::KeepFirst);
+
+  /// Adds multiple values from an initializer list (see \c addRange() above).
+  [[nodiscard]] bool addRange(std::initializer_list<Value> values,
+    Duplicates duplicates = Duplicates::KeepFirst);
+
+  /// Adds multiple values from an array (see \c addRange() above).
+  template <typename ArrayAlloc>
+  [[nodiscard]] bool addRange(Array<Value, ArrayAlloc> const& values,
+    Duplicates duplicates = Duplicates::KeepFirst);
+
+  /// Adds multiple values moved in from an array (see \c addRange() above). On success, the source array is
+  /// cleared.
+  template <typename ArrayAlloc>
+  [[nodiscard]] bool addRange(Array<Value, ArrayAlloc>&& values, Duplicates duplicates = Duplicates::KeepFirst);
+
   /// Erases value with the given key from the container, if such exists.
   bool erase(Value const& value) noexcept;
 
@@ -709,8 +1508,12 @@ public:
   bool find(Location& location, CustomValue const& value, CustomCompare const& compare) const;
 
 private:
+  // Frozen container takes over values of a container that is moved into it.
+  template <typename, typename, typename>
+  friend class FrozenFlatSet;
+
   // Container for integrated values.
-  typedef Array<Value> Values;
+  typedef Array<Value, Alloc> Values;
 
   // Integrated array of values.
   Values _values;
@@ -720,8 +1523,835 @@ private:
 
   // Attempts to find a given key using binary search.
   bool search(Length& index, Value const& value) const noexcept;
+
+  // Sorts, deduplicates and merges the given values with existing contents. Values are moved in unless the
+  // source type is constant.
+  template <typename Source>
+  bool mergeRange(Source* values, Length count, Duplicates duplicates);
+};
+
+/// Ordered keys arranged in Eytzinger layout, which is the common part of FrozenFlatMap and FrozenFlatSet.
+/// Keys are stored in breadth-first order of an implicit balanced binary search tree, where children of the
+/// key at index i are at indices 2i + 1 and 2i + 2. The topmost levels, which every search visits, share a few
+/// cache lines, and descendants of a key several levels below are next to each other, so they are prefetched
+/// while the search is still going through the levels above. Contents can only be replaced as a whole, while
+/// keys can be visited in ascending order through locations listed by \c begin() and \c end().
+template <typename Key, typename Comparer, typename Alloc>
+class EytzingerTree : public Containers
+{
+public:
+  /// Returns constant pointer to location of the smallest key. Locations are listed in ascending order of
+  /// their keys, which enables C++11 ranged for.
+  Location const* begin() const noexcept;
+
+  /// Returns constant pointer to one location past the location of the biggest key.
+  Location const* end() const noexcept;
+
+  /// Tests whether a container is not polluted. A polluted container has an error bit set.
+  /// This may indicate an error during memory allocation or some data corruption.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Returns number of keys in the container.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Tests whether the container is empty.
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Tests whether a given key exists in the container.
+  [[nodiscard]] bool exists(Key const& key) const noexcept;
+
+  /// Attempts to find a given key and returns its location. If the key was not found, returns location that
+  /// is not valid.
+  [[nodiscard]] Location find(Key const& key) const noexcept;
+
+  /// Returns constant reference to key at the given location.
+  [[nodiscard]] Key const& key(Location const& location) const noexcept;
+
+protected:
+  /// Container for keys in Eytzinger layout.
+  typedef Array<Key, Alloc> Keys;
+
+  /// Container for locations of keys in ascending order.
+  typedef Array<Location, Alloc> Order;
+
+  /// Keys in Eytzinger layout.
+  Keys _keys;
+
+  /// Locations of keys in ascending order.
+  Order _order;
+
+  /// Comparer module.
+  Comparer _comparer;
+
+  /// Creates an empty container.
+  EytzingerTree(Comparer&& comparer, Alloc&& alloc) noexcept;
+
+  /// Creates a new container copying keys and their locations from an existing one.
+  /// In case of a memory allocation failure, creates an empty polluted container (with an error bit set).
+  EytzingerTree(EytzingerTree const& tree);
+
+  /// Creates a new container with contents moved from another one.
+  EytzingerTree(EytzingerTree&&) noexcept = default;
+
+  /// Copies keys and their locations from another container into this one.
+  /// In case of a memory allocation failure, clears and pollutes current container (sets an error bit).
+  EytzingerTree& operator = (EytzingerTree const& tree);
+
+  /// Moves contents of another container into this one.
+  EytzingerTree& operator = (EytzingerTree&&) noexcept = default;
+
+  /// Releases memory of keys and their locations, and sets an error bit, so that a failed copy leaves
+  /// neither keys without locations, nor locations without keys.
+  void discard() noexcept;
+
+  /// Lays out the given number of sorted keys, filling locations of keys in ascending order and providing
+  /// the position in ascending order of a key to be stored at each location. Keys themselves are to be
+  /// added by derived class. In case of a memory allocation failure, returns false.
+  bool arrange(Array<Length, Alloc>& positions, Length count);
+
+  /// Attempts to find a given key, returning its index or \c NotFound.
+  Length search(Key const& key) const noexcept;
+
+private:
+  // Number of keys that fit into a cache line, rounded down to a power of two. Searches prefetch
+  // descendants that are this many times further from the root.
+  static Length constexpr const PrefetchStride = sizeof(Key) <= 4 ? 16 : sizeof(Key) <= 8 ? 8 :
+    sizeof(Key) <= 16 ? 4 : sizeof(Key) <= 32 ? 2 : 1;
+};
+
+/// Associative container between key and value pairs, which is built once from FlatMap and afterwards only
+/// queried (see EytzingerTree). Keys and values are stored in separate arrays, so that searches touch only
+/// the keys. For large containers, searches are a few times faster than those of FlatMap.
+template <typename Key, typename Value, typename Comparer = DefaultComparer<Key>, typename Alloc = Allocator>
+class FrozenFlatMap : public EytzingerTree<Key, Comparer, Alloc>
+{
+  // Base class of the container.
+  typedef EytzingerTree<Key, Comparer, Alloc> Tree;
+
+public:
+  /// Location of a key/value pair.
+  typedef Containers::Location Location;
+
+  /// Creates an empty container.
+  FrozenFlatMap(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from copies of pairs of the given map. In case of a memory allocation failure,
+  /// creates an empty polluted map (with an error bit set).
+  template <typename MapAlloc>
+  explicit FrozenFlatMap(FlatMap<Key, Value, Comparer, MapAlloc> const& map, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc());
+
+  /// Creates container from pairs moved from the given map, whose memory is released afterwards. In case of a
+  /// memory allocation failure, creates an empty polluted map (with an error bit set) and leaves the given map
+  /// unchanged.
+  template <typename MapAlloc>
+  explicit FrozenFlatMap(FlatMap<Key, Value, Comparer, MapAlloc>&& map, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc());
+
+  /// Creates a new container copying pairs from an existing one.
+  /// In case of a memory allocation failure, creates an empty polluted map (with an error bit set).
+  FrozenFlatMap(FrozenFlatMap const& map);
+
+  /// Creates a new container with contents moved from another one.
+  FrozenFlatMap(FrozenFlatMap&&) noexcept = default;
+
+  /// Copies the contents of source container into this one.
+  /// In case of a memory allocation failure, clears and pollutes current map (sets an error bit).
+  FrozenFlatMap& operator = (FrozenFlatMap const& map);
+
+  /// Moves contents of another container into this one.
+  FrozenFlatMap& operator = (FrozenFlatMap&&) noexcept = default;
+
+  /// Tests whether a container is not polluted. A polluted container has an error bit set.
+  /// This may indicate an error during memory allocation or some data corruption.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Clears container by removing all pairs.
+  void clear() noexcept;
+
+  /// Returns constant pointer to value associated with the given key.
+  /// If such key is not found, returns NULL.
+  [[nodiscard]] Value const* value(Key const& key) const noexcept;
+
+  /// Returns pointer to value associated with the given key. If such key is not found, returns NULL.
+  [[nodiscard]] Value* value(Key const& key) noexcept;
+
+  /// Returns constant reference to value at the given location.
+  [[nodiscard]] Value const& at(Location const& location) const noexcept;
+
+  /// Returns reference to value at the given location.
+  [[nodiscard]] Value& at(Location const& location) noexcept;
+
+  /// Sets an error bit in the container, marking it as polluted.
+  FrozenFlatMap& pollute() noexcept;
+
+  /// Resets error bit in the container, removing pollute status.
+  FrozenFlatMap& unpollute() noexcept;
+
+private:
+  // Values in the same order as keys.
+  Array<Value, Alloc> _values;
+
+  // Lays out sorted pairs, which are moved in unless the source type is constant.
+  template <typename Source>
+  bool build(Source* pairs, Containers::Length count);
+};
+
+/// A set of unique values, which is built once from FlatSet and afterwards only queried (see EytzingerTree).
+/// For large containers, searches are a few times faster than those of FlatSet.
+template <typename Value, typename Comparer = DefaultComparer<Value>, typename Alloc = Allocator>
+class FrozenFlatSet : public EytzingerTree<Value, Comparer, Alloc>
+{
+  // Base class of the container.
+  typedef EytzingerTree<Value, Comparer, Alloc> Tree;
+
+public:
+  /// Location of a value.
+  typedef Containers::Location Location;
+
+  /// Creates an empty container.
+  FrozenFlatSet(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from copies of values of the given set. In case of a memory allocation failure,
+  /// creates an empty polluted set (with an error bit set).
+  template <typename SetAlloc>
+  explicit FrozenFlatSet(FlatSet<Value, Comparer, SetAlloc> const& set, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc());
+
+  /// Creates container from values moved from the given set, whose memory is released afterwards. In case of a
+  /// memory allocation failure, creates an empty polluted set (with an error bit set) and leaves the given set
+  /// unchanged.
+  template <typename SetAlloc>
+  explicit FrozenFlatSet(FlatSet<Value, Comparer, SetAlloc>&& set, Comparer&& comparer = Comparer(),
+    Alloc&& alloc = Alloc());
+
+  /// Provides constant access to value at the given location.
+  [[nodiscard]] Value const& operator [] (Location const& location) const noexcept;
+
+  /// Clears container by removing all values.
+  void clear() noexcept;
+
+  /// Sets an error bit in the container, marking it as polluted.
+  FrozenFlatSet& pollute() noexcept;
+
+  /// Resets error bit in the container, removing pollute status.
+  FrozenFlatSet& unpollute() noexcept;
+
+private:
+  // Lays out sorted values, which are moved in unless the source type is constant.
+  template <typename Source>
+  bool build(Source* values, Containers::Length count);
 };
 
+/// Ordered container of elements using a B-tree for storage, which is the common part of Map and Set.
+/// Each node holds a sorted run of elements that occupies a few cache lines, so that searching touches only
+/// a handful of nodes, while adding and erasing elements moves at most one node worth of elements, instead
+/// of shifting the whole storage as FlatMap and FlatSet do. Adding or erasing elements invalidates all
+/// iterators, as well as pointers to elements.
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+class BTree : public Containers
+{
+protected:
+  /// Node of the tree, which is defined below.
+  struct Node;
+
+public:
+  /// Maximal number of elements in a single node, chosen so that the node occupies about four cache lines.
+  static int32_t constexpr const NodeCapacity = 256 / sizeof(Element) > 3 ?
+    static_cast<int32_t>(256 / sizeof(Element)) : 3;
+
+  /// Constant iterator over elements in ascending order.
+  class Iterator
+  {
+  public:
+    /// Returns constant reference to the current element.
+    Element const& operator * () const noexcept;
+
+    /// Returns constant pointer to the current element.
+    Element const* operator -> () const noexcept;
+
+    /// Moves to the next element in the container.
+    Iterator& operator ++ () noexcept;
+
+    /// Tests whether the iterator points to the same position as another iterator.
+    bool operator == (Iterator const& iterator) const noexcept;
+
+    /// Tests whether the iterator points to a different position than another iterator.
+    bool operator != (Iterator const& iterator) const noexcept;
+
+  private:
+    friend class BTree;
+
+    // Node of the current element, or NULL past the last element.
+    Node* _node;
+
+    // Index of the current element within its node.
+    int32_t _index;
+
+    // Creates iterator pointing to the element with the given index in the node, moving to the next node if
+    // the index is past the last element of the node.
+    Iterator(Node* node, int32_t index) noexcept;
+  };
+
+  /// Creates an empty container.
+  BTree(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates a new container copying elements from an existing container.
+  /// In case of a memory allocation failure, creates an empty polluted container (with an error bit set).
+  BTree(BTree const& tree);
+
+  /// Creates a new container with contents moved from another container.
+  BTree(BTree&& tree) noexcept;
+
+  /// Releases the container and all of its elements.
+  ~BTree();
+
+  /// Copies the contents of source container into this one.
+  /// In case of a memory allocation failure, pollutes current container (sets an error bit).
+  BTree& operator = (BTree const& tree);
+
+  /// Moves contents of another container into this one.
+  BTree& operator = (BTree&& tree) noexcept;
+
+  /// Returns iterator pointing to the first element in the container.
+  Iterator begin() const noexcept;
+
+  /// Returns iterator pointing to one element past last in the container.
+  Iterator end() const noexcept;
+
+  /// Returns constant reference to the first element in the container, which must not be empty.
+  [[nodiscard]] Element const& first() const noexcept;
+
+  /// Returns constant reference to the last element in the container, which must not be empty.
+  [[nodiscard]] Element const& last() const noexcept;
+
+  /// Tests whether a container is not polluted. A polluted container has an error bit set. This may indicate
+  /// an error during memory allocation or some data corruption.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Returns number of elements in the container.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Tests whether the container is empty.
+  bool empty() const noexcept;
+
+  /// Removes all elements and releases memory of the nodes.
+  void clear() noexcept;
+
+  /// Tests whether a given key is in the container.
+  [[nodiscard]] bool exists(Key const& key) const noexcept;
+
+  /// Attempts to find a given key, returning iterator pointing to its element, or \c end() if the key is
+  /// not in the container.
+  [[nodiscard]] Iterator find(Key const& key) const noexcept;
+
+  /// Returns iterator pointing to the first element whose key is not less than the given one, or \c end()
+  /// if there is no such element.
+  [[nodiscard]] Iterator lowerBound(Key const& key) const noexcept;
+
+  /// Returns iterator pointing to the first element whose key is greater than the given one, or \c end()
+  /// if there is no such element.
+  [[nodiscard]] Iterator upperBound(Key const& key) const noexcept;
+
+  /// Erases element with the given key from the container, if such exists.
+  bool erase(Key const& key) noexcept;
+
+  /// Erases element that the iterator points to from the container, if such exists.
+  bool erase(Iterator const& iterator) noexcept;
+
+  /// Erases all elements with keys from the range [from, to) and returns the number of erased elements.
+  /// The cost is logarithmic per erased element, but elements that follow each other within a node are
+  /// erased without searching again.
+  Length erase(Key const& from, Key const& to) noexcept;
+
+protected:
+  /// Attempts to find a given key. If the key was not found, returns node and index where an element with
+  /// such key should be inserted.
+  bool search(Node*& node, int32_t& index, Key const& key) const noexcept;
+
+  /// Returns reference to element with the given index in the node.
+  static Element& element(Node* node, int32_t index) noexcept;
+
+  /// Inserts element at the node and index returned by \c search(), splitting nodes that are full.
+  /// In case of a memory allocation failure, returns false and leaves the container unchanged.
+  [[nodiscard]] bool insert(Node* node, int32_t index, Element&& element);
+
+  /// Sets or resets an error bit in the container.
+  void polluted(bool polluted) noexcept;
+
+  /// Node of the tree, which holds sorted elements. Internal nodes also have children.
+  struct Node
+  {
+    /// Parent node, or NULL for the root.
+    Node* parent;
+
+    /// Index of this node among the children of its parent.
+    int32_t position;
+
+    /// Number of elements in the node.
+    int32_t length;
+
+    /// Tests whether the node has no children.
+    bool leaf;
+
+    /// Storage for elements, valid only for the first "length" of them.
+    alignas(Element) uint8_t elements[NodeCapacity * sizeof(Element)];
+  };
+
+private:
+  // Minimal number of elements in all nodes but the root.
+  static int32_t constexpr const NodeMinLength = (NodeCapacity - 1) / 2;
+
+  // Maximal number of levels in the tree, each having at least two children per node.
+  static int32_t constexpr const MaxHeight = 8 * sizeof(Length);
+
+  // Node of the tree that has children.
+  struct InternalNode : Node
+  {
+    // Children of the node, one more than the number of elements.
+    Node* children[NodeCapacity + 1];
+  };
+
+  // Root node, or NULL when the container is empty.
+  Node* _root;
+
+  // Number of elements in the container combined with pollute bit.
+  Size _length;
+
+  // Comparer module.
+  Comparer _comparer;
+
+  // Memory allocator.
+  Alloc _alloc;
+
+  // Returns key of a key/value pair.
+  template <typename PairValue>
+  static Key const& elementKey(Pair<Key, PairValue> const& pair) noexcept;
+
+  // Returns the element itself, when it is also the key.
+  static Key const& elementKey(Key const& key) noexcept;
+
+  // Returns pointer to the given child of an internal node.
+  static Node*& child(Node* node, int32_t index) noexcept;
+
+  // Finds the first element, whose key is not less than the given one (or greater than the given one when
+  // "upper" is set) within the node.
+  int32_t bound(Node const* node, Key const& key, bool upper) const noexcept;
+
+  // Returns iterator pointing to the first element whose key is not less (or greater) than the given one.
+  Iterator bound(Key const& key, bool upper) const noexcept;
+
+  // Allocates an empty node.
+  Node* allocate(bool leaf) noexcept;
+
+  // Releases memory of the node.
+  void release(Node* node) noexcept;
+
+  // Moves elements to a new memory location, which may overlap with the source, leaving source memory
+  // uninitialized.
+  static void relocate(Element* dest, Element* source, int32_t count) noexcept;
+
+  // Moves children of internal nodes into another node (or the same one) at the given index, updating their
+  // parent and position.
+  static void moveChildren(Node* dest, int32_t destIndex, Node* source, int32_t sourceIndex,
+    int32_t count) noexcept;
+
+  // Splits a full node in two, using a pre-allocated sibling. The middle element is moved to the parent,
+  // which must not be full, or to a pre-allocated new root.
+  void split(Node* node, Node* sibling, Node* root) noexcept;
+
+  // Removes element with the given index from the node, rebalancing the tree afterwards. Returns true if
+  // other elements have been moved to different nodes, so that the next element is no longer at the same
+  // node and index.
+  bool eraseAt(Node* node, int32_t index) noexcept;
+
+  // Restores the minimal number of elements of a node that has one element less, by borrowing an element
+  // from a sibling or by merging with it, and continues with the parent after merging.
+  void rebalance(Node* node) noexcept;
+
+  // Merges the child at the given index of the parent with the next child, together with the element that
+  // separates them.
+  void merge(Node* parent, int32_t index) noexcept;
+
+  // Creates a copy of the node together with all its descendants, returning NULL on memory allocation
+  // failure.
+  Node* copyNode(Node const* node, Node* parent);
+
+  // Calls destructors for all elements of the node and its descendants and releases their memory.
+  void releaseNode(Node* node) noexcept;
+};
+
+/// Associative container between key and value pairs using a B-tree for storage (see BTree). Unlike
+/// FlatMap, adding and erasing pairs has logarithmic cost, so it suits large containers that change often.
+template <typename Key, typename Value, typename Comparer = DefaultComparer<Key>, typename Alloc = Allocator>
+class Map : public BTree<Containers::Pair<Key, Value>, Key, Comparer, Alloc>
+{
+  // Base class of the container.
+  typedef BTree<Containers::Pair<Key, Value>, Key, Comparer, Alloc> Tree;
+
+public:
+  /// Pair that represents both key and value.
+  typedef Containers::Pair<Key, Value> KeyValue;
+
+  /// Iterator over key/value pairs in ascending order of keys.
+  typedef typename Tree::Iterator Iterator;
+
+  /// Creates an empty container.
+  Map(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from an initializer list. Duplicate keys are resolved by keeping the last pair.
+  /// In case of a memory allocation failure, creates a polluted map (with an error bit set).
+  Map(std::initializer_list<KeyValue> pairs, Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc());
+
+  /// Adds or updates a key/value pair to the container. In case of a memory allocation failure, returns false.
+  [[nodiscard]] bool add(Key const& key, Value const& value);
+
+  /// Adds or updates a key and (moved in) value pair to the container.
+  [[nodiscard]] bool add(Key const& key, Value&& value);
+
+  /// Adds or updates a (moved in) key and value pair to the container.
+  [[nodiscard]] bool add(Key&& key, Value const& value);
+
+  /// Adds or updates a moved in key/value pair to the container.
+  [[nodiscard]] bool add(Key&& key, Value&& value);
+
+  /// Adds or updates a key/value pair to the container. In case of a memory allocation failure, sets an
+  /// error bit, marking container as polluted.
+  Map& addp(Key const& key, Value const& value);
+
+  /// Adds or updates a key/value pair to the container. In case of a memory allocation failure, sets an
+  /// error bit, marking container as polluted.
+  Map& addp(Key const& key, Value&& value);
+
+  /// Adds or updates a key/value pair to the container. In case of a memory allocation failure, sets an
+  /// error bit, marking container as polluted.
+  Map& addp(Key&& key, Value const& value);
+
+  /// Adds or updates a key/value pair to the container. In case of a memory allocation failure, sets an
+  /// error bit, marking container as polluted.
+  Map& addp(Key&& key, Value&& value);
+
+  /// Returns constant pointer to value associated with the given key.
+  /// If such key is not found, returns NULL.
+  [[nodiscard]] Value const* value(Key const& key) const noexcept;
+
+  /// Returns pointer to value associated with the given key. If such key is not found, returns NULL.
+  [[nodiscard]] Value* value(Key const& key) noexcept;
+
+  /// Returns constant reference to value that the iterator points to.
+  [[nodiscard]] Value const& at(Iterator const& iterator) const noexcept;
+
+  /// Returns reference to value that the iterator points to.
+  [[nodiscard]] Value& at(Iterator const& iterator) noexcept;
+
+  /// Sets an error bit in the container, marking it as polluted.
+  Map& pollute() noexcept;
+
+  /// Resets error bit in the container, removing pollute status.
+  Map& unpollute() noexcept;
+
+private:
+  // Adds or updates a key/value pair, forwarding arguments to pair's constructor or value's assignment.
+  template <typename KeyType, typename ValueType>
+  bool elementAdd(KeyType&& key, ValueType&& value);
+};
+
+/// A set of unique values using a B-tree for storage (see BTree). Unlike FlatSet, adding and erasing values
+/// has logarithmic cost, so it suits large containers that change often.
+template <typename Value, typename Comparer = DefaultComparer<Value>, typename Alloc = Allocator>
+class Set : public BTree<Value, Value, Comparer, Alloc>
+{
+  // Base class of the container.
+  typedef BTree<Value, Value, Comparer, Alloc> Tree;
+
+public:
+  /// Iterator over values in ascending order.
+  typedef typename Tree::Iterator Iterator;
+
+  /// Creates an empty container.
+  Set(Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from an initializer list. Duplicate values are resolved by keeping the first one.
+  /// In case of a memory allocation failure, creates a polluted set (with an error bit set).
+  Set(std::initializer_list<Value> values, Comparer&& comparer = Comparer(), Alloc&& alloc = Alloc());
+
+  /// Adds a value to the container, unless it is already there. In case of a memory allocation failure,
+  /// returns false.
+  [[nodiscard]] bool add(Value const& value);
+
+  /// Adds a (moved in) value to the container, unless it is already there.
+  [[nodiscard]] bool add(Value&& value);
+
+  /// Adds or updates value in the container.
+  [[nodiscard]] bool update(Value const& value);
+
+  /// Adds or updates (moved in) value in the container.
+  [[nodiscard]] bool update(Value&& value);
+
+  /// Adds a value to the container. In case of a memory allocation failure, sets an error bit, marking
+  /// container as polluted.
+  Set& addp(Value const& value);
+
+  /// Adds a value to the container. In case of a memory allocation failure, sets an error bit, marking
+  /// container as polluted.
+  Set& addp(Value&& value);
+
+  /// Sets an error bit in the container, marking it as polluted.
+  Set& pollute() noexcept;
+
+  /// Resets error bit in the container, removing pollute status.
+  Set& unpollute() noexcept;
+
+private:
+  // Adds or updates value, forwarding it to element's constructor or assignment.
+  template <typename ValueType>
+  bool elementAdd(ValueType&& value, bool update);
+};
+
+/// Associative container between key and value pairs using an open-addressing hash table for storage.
+/// Hasher must provide a function that computes hash of a key and a function that tests two keys for
+/// equality (see \c DefaultHasher). The order of elements in the container is unspecified.
+template <typename Key, typename Value, typename Hasher = DefaultHasher<Key>, typename Alloc = Allocator>
+class HashMap : public Containers
+{
+public:
+  /// Pair that represents both key and value.
+  typedef Pair<Key, Value> KeyValue;
+
+  /// Constant iterator over key/value pairs in the container.
+  class Iterator
+  {
+  public:
+    /// Returns constant reference to the current key/value pair.
+    KeyValue const& operator * () const noexcept;
+
+    /// Returns constant pointer to the current key/value pair.
+    KeyValue const* operator -> () const noexcept;
+
+    /// Moves to the next key/value pair in the container.
+    Iterator& operator ++ () noexcept;
+
+    /// Tests whether the iterator points to the same position as another iterator.
+    bool operator == (Iterator const& iterator) const noexcept;
+
+    /// Tests whether the iterator points to a different position than another iterator.
+    bool operator != (Iterator const& iterator) const noexcept;
+
+  private:
+    friend class HashMap;
+
+    // Container being iterated.
+    HashMap const* _map;
+
+    // Index of the current slot.
+    Length _index;
+
+    // Creates iterator pointing to the first occupied slot at or after the given index.
+    Iterator(HashMap const* map, Length index) noexcept;
+  };
+
+  /// Creates an empty container.
+  HashMap(Hasher&& hasher = Hasher(), Alloc&& alloc = Alloc()) noexcept;
+
+  /// Creates container from an initializer list.
+  HashMap(std::initializer_list<KeyValue> pairs, Hasher&& hasher = Hasher(), Alloc&& alloc = Alloc());
+
+  /// Creates a new container copying elements from an existing container.
+  /// In case of a memory allocation failure, creates an empty polluted map (with an error bit set).
+  HashMap(HashMap const& map);
+
+  /// Creates a new container with contents moved from another container.
+  HashMap(HashMap&& map) noexcept;
+
+  /// Releases the container and all of its elements.
+  ~HashMap();
+
+  /// Copies the contents of source container into this one.
+  /// In case of a memory allocation failure, pollutes current container (sets an error bit).
+  HashMap& operator = (HashMap const& map);
+
+  /// Moves contents of another container into this one.
+  HashMap& operator = (HashMap&& map) noexcept;
+
+  /// Provides location-based access to the container.
+  [[nodiscard]] KeyValue const& operator [] (Location const& location) const noexcept;
+
+  /// Returns iterator pointing to the first pair in the container.
+  Iterator begin() const noexcept;
+
+  /// Returns iterator pointing to one pair past last in the container.
+  Iterator end() const noexcept;
+
+  /// Tests whether a container is not polluted. A polluted buffer has an error bit set. This may indicate
+  /// an error during memory allocation or some data corruption.
+  [[nodiscard]] explicit operator bool () const noexcept;
+
+  /// Returns number of elements that container can hold before realloacating to a greater capacity.
+  [[nodiscard]] Length capacity() const noexcept;
+
+  /// Increases container capacity to accomodate at least the requested number of elements.
+  [[nodiscard]] bool capacity(Length capacity);
+
+  /// Returns number of elements in the container.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Clears container by removing all elements but without releasing pre-allocated memory.
+  void clear() noexcept;
+
+  /// Shrinks container so that its capacity will be the minimal one to store actual number of elements.
+  [[nodiscard]] bool shrink() noexcept;
+
+  /// Clears the container and releases any pre-allocated memory.
+  void purge() noexcept;
+
+  /// Tests whether a given key is already in the container.
+  [[nodiscard]] bool exists(Key const& key) const noexcept;
+
+  /// Adds or updates a key/value pair to the container, returning its location.
+  /// Warning: adding new elements may invalidate previously obtained locations.
+  [[nodiscard]] Location add(Key const& key, Value const& value);
+
+  /// Adds or updates a key and (moved in) value pair to the container, returning its location.
+  /// Warning: adding new elements may invalidate previously obtained locations.
+  [[nodiscard]] Location add(Key const& key, Value&& value);
+
+  /// Adds or updates a (moved in) key and value pair to the container, returning its location.
+  /// Warning: adding new elements may invalidate previously obtained locations.
+  [[nodiscard]] Location add(Key&& key, Value const& value);
+
+  /// Adds or updates a moved in key/value pair to the container, returning its location.
+  /// Warning: adding new elements may invalidate previously obtained locations.
+  [[nodiscard]] Location add(Key&& key, Value&& value);
+
+  /// Adds or updates a key/value pair to the container. In case of an overflow or a memory allocation
+  /// failure, sets an error bit, marking container as polluted.
+  HashMap& addp(Key const& key, Value const& value);
+
+  /// Adds or updates a key/value pair to the container. In case of an overflow or a memory allocation
+  /// failure, sets an error bit, marking container as polluted.
+  HashMap& addp(Key const& key, Value&& value);
+
+  /// Adds or updates a key/value pair to the container. In case of an overflow or a memory allocation
+  /// failure, sets an error bit, marking container as polluted.
+  HashMap& addp(Key&& key, Value const& value);
+
+  /// Adds or updates a key/value pair to the container. In case of an overflow or a memory allocation
+  /// failure, sets an error bit, marking container as polluted.
+  HashMap& addp(Key&& key, Value&& value);
+
+  /// Erases value with the given key from the container, if such exists.
+  bool erase(Key const& key) noexcept;
+
+  /// Removes value at the given location from the container, if such exists.
+  bool erase(Location const& location) noexcept;
+
+  /// Returns constant pointer to value associated with the given key.
+  /// If such key is not found, returns NULL.
+  [[nodiscard]] Value const* value(Key const& key) const noexcept;
+
+  /// Returns pointer to value associated with the given key. If such key is not found, returns NULL.
+  [[nodiscard]] Value* value(Key const& key) noexcept;
+
+  /// Returns constant reference to value associated with the given location.
+  [[nodiscard]] Value const& at(Location const& location) const noexcept;
+
+  /// Returns reference to value associated with the given location.
+  [[nodiscard]] Value& at(Location const& location) noexcept;
+
+  /// Attempts to find a given key and returns its location.
+  [[nodiscard]] Location find(Key const& key) const noexcept;
+
+  /// Tests whether the container is empty.
+  bool empty() const noexcept;
+
+  /// Sets an error bit in the container, marking it as polluted.
+  HashMap& pollute() noexcept;
+
+  /// Resets error bit in the container, removing pollute status.
+  HashMap& unpollute() noexcept;
+
+private:
+  // Minimal number of slots in a non-empty table.
+  static Length constexpr const MinSlots = GroupWidth;
+
+  // Control bytes for each slot followed by a copy of the first group to allow unaligned group loads
+  // near the end of the table.
+  Control* _controls;
+
+  // Storage for key/value pairs, valid only for occupied slots.
+  KeyValue* _slots;
+
+  // Number of slots in the table (always zero or a power of two) combined with pollute bit.
+  Size _capacity;
+
+  // Number of elements stored in the table.
+  Length _length;
+
+  // Number of elements that can be added before the table needs to be rehashed.
+  Length _growthLeft;
+
+  // Hashing module.
+  Hasher _hasher;
+
+  // Memory allocator.
+  Alloc _alloc;
+
+  // Returns number of slots in the table.
+  Length slots() const noexcept;
+
+  // Returns maximal number of elements that the table with given number of slots can hold.
+  static Length slotsCapacity(Length slots) noexcept;
+
+  // Returns the number of bytes needed to store control bytes and key/value pairs for the given number of
+  // slots, and the offset of key/value pairs within that memory block.
+  static size_t blockSize(Length slots, size_t& slotsOffset) noexcept;
+
+  // Attempts to find a given key with pre-computed hash, returning its index.
+  Length search(Key const& key, size_t hash) const noexcept;
+
+  // Finds first unoccupied slot in the probe sequence for the given hash.
+  Length searchFree(size_t hash) const noexcept;
+
+  // Reserves a slot for a new element with the given hash, growing the table if necessary.
+  Length prepareInsert(size_t hash);
+
+  // Adds or updates a key/value pair, forwarding arguments to pair's constructor or value's assignment.
+  template <typename KeyType, typename ValueType>
+  Location elementAdd(KeyType&& key, ValueType&& value);
+
+  // Removes an element at the given slot index.
+  void elementErase(Length index) noexcept;
+
+  // Updates control byte at the given slot index, including its copy at the end of the table.
+  void setControl(Length index, Control control) noexcept;
+
+  // Moves all elements to a new table with the given number of slots.
+  [[nodiscard]] bool rehash(Length slots);
+
+  // Copies all elements from another container, which must have the same number of slots.
+  void copyFrom(HashMap const& map);
+
+  // Calls destructors for all elements and releases allocated memory.
+  void deallocate() noexcept;
+};
+
+namespace utility {
+
+/// Pairs are trivially relocatable when both key and value are.
+template <typename Key, typename Value>
+struct TriviallyRelocatable<Containers::Pair<Key, Value>>
+{
+  static bool constexpr const value = TriviallyRelocatable<Key>::value && TriviallyRelocatable<Value>::value;
+};
+
+/// Arrays only refer to external memory, so they are trivially relocatable when their allocator is.
+template <typename Element, typename Alloc>
+struct TriviallyRelocatable<Array<Element, Alloc>>
+{
+  static bool constexpr const value = TriviallyRelocatable<Alloc>::value;
+};
+
+} // namespace utility
 } // namespace trl
 
 #include "TinyTRL_Containers.inl"
\ No newline at end of file
@@ -63,6 +63,171 @@ inline void* CAllocator::alloc(void* const data, size_t, size_t const requestedB
   }
 }
 
+// NullAllocator members.
+
+inline void* NullAllocator::alloc(size_t, size_t) noexcept
+{
+  return nullptr;
+}
+
+inline void NullAllocator::free(void*, size_t, size_t) noexcept
+{
+}
+
+// MonotonicArena<Upstream> members.
+
+template <typename Upstream>
+MonotonicArena<Upstream>::MonotonicArena(size_t const chunkSize, Upstream&& upstream) noexcept
+: MonotonicArena(nullptr, 0, chunkSize, static_cast<Upstream&&>(upstream))
+{
+}
+
+template <typename Upstream>
+MonotonicArena<Upstream>::MonotonicArena(void* const buffer, size_t const bufferSize, size_t const chunkSize,
+  Upstream&& upstream) noexcept
+: _buffer(static_cast<uint8_t*>(buffer)),
+  _bufferSize(buffer ? bufferSize : 0),
+  _chunks(nullptr),
+  _chunk(nullptr),
+  _head(_buffer),
+  _end(_buffer + _bufferSize),
+  _chunkSize(math::max(chunkSize, sizeof(Chunk))),
+  _upstream(static_cast<Upstream&&>(upstream))
+{
+}
+
+template <typename Upstream>
+MonotonicArena<Upstream>::~MonotonicArena()
+{
+  release();
+}
+
+template <typename Upstream>
+inline void* MonotonicArena<Upstream>::alloc(size_t const numBytes, size_t const alignment) noexcept
+{
+  if (void* const data = allocHead(numBytes, alignment))
+    return data;
+  return allocChunk(numBytes, alignment);
+}
+
+template <typename Upstream>
+inline void MonotonicArena<Upstream>::free(void* const data, size_t const numBytes, size_t) noexcept
+{
+  if (data && static_cast<uint8_t*>(data) + numBytes == _head)
+    _head = static_cast<uint8_t*>(data);
+}
+
+template <typename Upstream>
+void MonotonicArena<Upstream>::reset() noexcept
+{
+  _chunk = nullptr;
+  _head = _buffer;
+  _end = _buffer + _bufferSize;
+}
+
+template <typename Upstream>
+void MonotonicArena<Upstream>::release() noexcept
+{
+  while (Chunk* const chunk = _chunks)
+  {
+    _chunks = chunk->next;
+    _upstream.free(chunk, chunk->size, alignof(Chunk));
+  }
+  reset();
+}
+
+template <typename Upstream>
+inline void* MonotonicArena<Upstream>::allocHead(size_t const numBytes, size_t const alignment) noexcept
+{
+  uintptr_t const start = (reinterpret_cast<uintptr_t>(_head) + alignment - 1) &
+    ~static_cast<uintptr_t>(alignment - 1);
+  uintptr_t const end = reinterpret_cast<uintptr_t>(_end);
+
+  if (!_head || start > end || numBytes > end - start)
+    return nullptr;
+
+  _head = reinterpret_cast<uint8_t*>(start + numBytes);
+  return reinterpret_cast<void*>(start);
+}
+
+template <typename Upstream>
+void* MonotonicArena<Upstream>::allocChunk(size_t const numBytes, size_t const alignment) noexcept
+{
+  if (numBytes > SIZE_MAX - sizeof(Chunk) - alignment)
+    return nullptr; // Overflow.
+
+  size_t const required = sizeof(Chunk) + numBytes + alignment - 1;
+  Chunk* next = _chunk ? _chunk->next : _chunks;
+
+  // Chunks that remain after reset are reused, unless they are too small for the requested block.
+  if (!next || next->size < required)
+  {
+    size_t size = math::max(_chunkSize, required);
+    if (_chunk && _chunk->size <= SIZE_MAX / 2)
+      size = math::max(size, _chunk->size * 2);
+
+    Chunk* const chunk = static_cast<Chunk*>(_upstream.alloc(size, alignof(Chunk)));
+    if (!chunk)
+      return nullptr;
+
+    chunk->next = next;
+    chunk->size = size;
+
+    if (_chunk)
+      _chunk->next = chunk;
+    else
+      _chunks = chunk;
+
+    next = chunk;
+  }
+  _chunk = next;
+  _head = reinterpret_cast<uint8_t*>(next + 1);
+  _end = reinterpret_cast<uint8_t*>(next) + next->size;
+
+  return allocHead(numBytes, alignment);
+}
+
+// ArenaAllocator<Upstream> members.
+
+template <typename Upstream>
+inline ArenaAllocator<Upstream>::ArenaAllocator(MonotonicArena<Upstream>& arena) noexcept
+: _arena(&arena)
+{
+}
+
+template <typename Upstream>
+inline void* ArenaAllocator<Upstream>::alloc(size_t const numBytes, size_t const alignment) noexcept
+{
+  return _arena->alloc(numBytes, alignment);
+}
+
+template <typename Upstream>
+inline void ArenaAllocator<Upstream>::free(void* const data, size_t const numBytes,
+  size_t const alignment) noexcept
+{
+  _arena->free(data, numBytes, alignment);
+}
+
+// AllocatorResource<Alloc> members.
+
+template <typename Alloc>
+AllocatorResource<Alloc>::AllocatorResource(Alloc&& alloc) noexcept
+: _alloc(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Alloc>
+void* AllocatorResource<Alloc>::alloc(size_t const numBytes, size_t const alignment) noexcept
+{
+  return _alloc.alloc(numBytes, alignment);
+}
+
+template <typename Alloc>
+void AllocatorResource<Alloc>::free(void* const data, size_t const numBytes, size_t const alignment) noexcept
+{
+  _alloc.free(data, numBytes, alignment);
+}
+
 // DefaultCompare members.
 
 template <typename Value>
@@ -80,6 +245,47 @@ constexpr int8_t DefaultComparer<Value>::operator () (Value const& left, Value c
   return DefaultCompare::perform(left, right);
 }
 
+// DefaultHash members.
+
+template <typename Value>
+size_t DefaultHash::perform(Value const& value)
+{
+  static_assert(__has_unique_object_representations(Value),
+    "Values with padding or multiple binary representations need a custom hasher.");
+
+  uint8_t const* const bytes = reinterpret_cast<uint8_t const*>(&value);
+  uint64_t hash = sizeof(Value);
+
+  for (size_t offset = 0; offset < sizeof(Value); offset += sizeof(uint64_t))
+  {
+    uint64_t bits = 0;
+    memcpy(&bits, bytes + offset, math::min(sizeof(Value) - offset, sizeof(uint64_t)));
+
+    // MurmurHash3 finalizer to spread all input bits evenly.
+    hash ^= bits;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+  }
+  return static_cast<size_t>(hash);
+}
+
+// DefaultHasher members.
+
+template <typename Value>
+size_t DefaultHasher<Value>::operator () (Value const& value) const
+{
+  return DefaultHash::perform(value);
+}
+
+template <typename Value>
+bool DefaultHasher<Value>::operator () (Value const& left, Value const& right) const
+{
+  return left == right;
+}
+
 // Containers members.
 
 /// Calculates next exponentially-growing buffer capacity.
@@ -94,6 +300,72 @@ inline Containers::Length Containers::computeCapacity(Length const targetCapacit
   return capacity;
 }
 
+inline void Containers::prefetch(void const* const address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#elif defined(__PLATFORM_SSE2)
+  _mm_prefetch(static_cast<char const*>(address), _MM_HINT_T0);
+#else
+  (void)address;
+#endif
+}
+
+template <typename Element, typename SearchValue, typename Compare>
+bool Containers::searchSorted(Length& index, Element const* const elements, Length const count,
+  SearchValue const& value, Compare const& compare) noexcept
+{
+  // Values such as strings are compared through pointers, where branch prediction lets the processor load the
+  // next candidate ahead of time, so they benefit more from a classic search that stops at the first match.
+  if constexpr (!__is_trivially_copyable(SearchValue))
+  {
+    Length left = 0, right = count - 1;
+
+    while (left <= right)
+    {
+      Length const pivot = (left + right) / 2;
+      auto const res = compare(elements[pivot], value);
+
+      if (res < 0)
+        left = pivot + 1;
+      else if (res > 0)
+        right = pivot - 1;
+      else
+      {
+        index = pivot;
+        return true; // Value found.
+      }
+    }
+    index = left;
+    return false; // Value not found.
+  }
+  else
+  {
+    Element const* first = elements;
+    Length length = count;
+
+    // The first element that is not less than the value is always within [first, first + length].
+    while (length > SearchLinearLength)
+    {
+      Length const half = length / 2;
+      Length const nextHalf = (length - half) / 2;
+
+      prefetch(first + nextHalf);
+      prefetch(first + half + nextHalf);
+
+      first += (compare(first[half], value) < 0) * half;
+      length -= half;
+    }
+
+    index = first - elements;
+
+    for (Length i = 0; i < length; ++i)
+      index += compare(first[i], value) < 0;
+
+    return index < count && compare(elements[index], value) == 0;
+  }
+}
+
 // Containers::Pair members.
 
 template <typename Key, typename Value>
@@ -197,6 +469,86 @@ constexpr Containers::Length Containers::Location::index() const
   return _index;
 }
 
+// Containers::ControlMask members.
+
+constexpr Containers::ControlMask::ControlMask(uint64_t const bits)
+: _bits(bits)
+{
+}
+
+constexpr Containers::ControlMask::operator bool () const
+{
+  return _bits != 0;
+}
+
+inline int32_t Containers::ControlMask::lowest() const noexcept
+{
+  return math::countTrailingZeros(_bits) >> Shift;
+}
+
+inline int32_t Containers::ControlMask::leadingZeros() const noexcept
+{
+  return (math::countLeadingZeros(_bits) - (64 - (static_cast<int32_t>(GroupWidth) << Shift))) >> Shift;
+}
+
+inline void Containers::ControlMask::next() noexcept
+{
+  _bits &= _bits - 1;
+}
+
+// Containers::ControlGroup members.
+
+inline Containers::ControlGroup::ControlGroup(Control const* const controls) noexcept
+{
+#if defined(__PLATFORM_SSE2)
+  _controls = _mm_loadu_si128(reinterpret_cast<__m128i const*>(controls));
+#elif defined(__PLATFORM_NEON)
+  _controls = vld1q_s8(controls);
+#else
+  memcpy(_controls, controls, GroupWidth);
+#endif
+}
+
+inline Containers::ControlMask Containers::ControlGroup::match(Control const hash) const noexcept
+{
+#if defined(__PLATFORM_SSE2)
+  return ControlMask(static_cast<uint32_t>(_mm_movemask_epi8(
+    _mm_cmpeq_epi8(_controls, _mm_set1_epi8(hash)))));
+#elif defined(__PLATFORM_NEON)
+  // Narrow each byte of comparison result to 4 bits and keep a single bit per byte.
+  uint8x16_t const res = vceqq_s8(_controls, vdupq_n_s8(hash));
+  return ControlMask(vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(res), 4)), 0) &
+    0x8888888888888888ull);
+#else
+  uint64_t bits = 0;
+  for (Length i = 0; i < GroupWidth; ++i)
+    bits |= static_cast<uint64_t>(_controls[i] == hash) << i;
+  return ControlMask(bits);
+#endif
+}
+
+inline Containers::ControlMask Containers::ControlGroup::matchEmpty() const noexcept
+{
+  return match(ControlEmpty);
+}
+
+inline Containers::ControlMask Containers::ControlGroup::matchEmptyOrDeleted() const noexcept
+{
+  // Unoccupied slots are the only ones with negative control bytes.
+#if defined(__PLATFORM_SSE2)
+  return ControlMask(static_cast<uint32_t>(_mm_movemask_epi8(_controls)));
+#elif defined(__PLATFORM_NEON)
+  uint8x16_t const res = vcltq_s8(_controls, vdupq_n_s8(0));
+  return ControlMask(vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(res), 4)), 0) &
+    0x8888888888888888ull);
+#else
+  uint64_t bits = 0;
+  for (Length i = 0; i < GroupWidth; ++i)
+    bits |= static_cast<uint64_t>(_controls[i] < 0) << i;
+  return ControlMask(bits);
+#endif
+}
+
 // Array<Element, Alloc> members.
 
 template <typename Element, typename Alloc>
@@ -401,6 +753,12 @@ Array<Element, Alloc>::operator bool () const noexcept
   return !(_capacity & PolluteBit);
 }
 
+template <typename Element, typename Alloc>
+Alloc const& Array<Element, Alloc>::allocator() const noexcept
+{
+  return _alloc;
+}
+
 template <typename Element, typename Alloc>
 typename Array<Element, Alloc>::Length Array<Element, Alloc>::capacity() const noexcept
 {
@@ -481,7 +839,7 @@ bool Array<Element, Alloc>::shrink() noexcept
 template <typename Element, typename Alloc>
 void Array<Element, Alloc>::purge() noexcept
 {
-  if (length())
+  if (capacity())
   {
     deallocate();
     _data = nullptr;
@@ -510,6 +868,27 @@ bool Array<Element, Alloc>::populate(Length count, Element const& value)
     return NotFound; // Overflow
 }
 
+template <typename Element, typename Alloc>
+template <typename ElementsConstruct>
+bool Array<Element, Alloc>::expand(Length count, ElementsConstruct const& elementsConstruct)
+{
+  count = math::max<Length>(count, 0);
+
+  if (Length const length = this->length(); length <= MaxLength - count)
+  {
+    if (capacity(length + count))
+    {
+      elementsConstruct(_data + length);
+      _length = static_cast<Size>(length + count);
+      return true;
+    }
+    else
+      return false; // Memory allocation failure
+  }
+  else
+    return false; // Overflow
+}
+
 template <typename Element, typename Alloc>
 typename Array<Element, Alloc>::Length Array<Element, Alloc>::add(Element const& element)
 {
@@ -573,12 +952,7 @@ bool Array<Element, Alloc>::erase(Length const index) noexcept
   if (Length const length = this->length(); index >= 0 && index < length)
   {
     _data[index].~Element();
-
-    for (Length i = index; i < length - 1; ++i)
-    {
-      new (_data + i) Element(static_cast<Element&&>(_data[i + 1]));
-      _data[i + 1].~Element();
-    }
+    relocate(_data + index, _data + index + 1, length - index - 1);
     _length = static_cast<Size>(length - 1);
     return true;
   }
@@ -605,11 +979,7 @@ bool Array<Element, Alloc>::erase(Length start, Length count) noexcept
     for (Length i = right; --i >= start; )
       _data[i].~Element();
 
-    for (Length i = start; i < length - cut; ++i)
-    {
-      new (_data + i) Element(static_cast<Element&&>(_data[i + cut]));
-      _data[i + cut].~Element();
-    }
+    relocate(_data + start, _data + right, length - right);
     _length = static_cast<Size>(length - cut);
     return true;
   }
@@ -654,6 +1024,83 @@ void Array<Element, Alloc>::quickSort(Length const first, Length const last, Com
       math::saturate<Length>(last, 0, length - 1), comparer);
 }
 
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::sort(Length const first, Length const last, Comparer const& comparer)
+{
+  if (Length const length = this->length(); length > 1)
+  {
+    Length const left = math::saturate<Length>(first, 0, length - 1);
+    Length const right = math::saturate<Length>(last, 0, length - 1);
+
+    if (left < right)
+      introSort(left, right, 2 * math::log2(static_cast<uint64_t>(right - left + 1)), true, comparer);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::parallelSort(Comparer const& comparer, int32_t threads)
+{
+  Length const length = this->length();
+
+  if (threads <= 0)
+    threads = processorCount();
+
+  threads = static_cast<int32_t>(math::min<Length>(math::min(threads, MaxParallelThreads),
+    length / ParallelSortMinLength));
+
+  if (threads < 2)
+  {
+    sort(0, MaxLength, comparer);
+    return;
+  }
+
+  Element* const buffer = alloc(length);
+  if (!buffer)
+  {
+    pollute();
+    sort(0, MaxLength, comparer);
+    return;
+  }
+
+  ParallelSort<Comparer> state;
+  state.array = this;
+  state.comparer = &comparer;
+  state.source = _data;
+  state.dest = buffer;
+  state.threads = threads;
+  state.runs = threads;
+
+  for (int32_t i = 0; i <= threads; ++i)
+    state.bounds[i] = length * i / threads;
+
+  runParallel(parallelSortChunk<Comparer>, &state, threads);
+
+  // Merge pairs of adjacent runs until a single one remains, moving elements between array and buffer.
+  while (state.runs > 1)
+  {
+    parallelSplit(state);
+    runParallel(parallelMerge<Comparer>, &state, threads);
+
+    int32_t const runs = (state.runs + 1) / 2;
+
+    for (int32_t i = 1; i < runs; ++i)
+      state.bounds[i] = state.bounds[i * 2];
+
+    state.bounds[runs] = length;
+    state.runs = runs;
+    utility::swap(state.source, state.dest);
+  }
+
+  if (state.source != _data)
+  {
+    state.dest = _data;
+    runParallel(parallelMove<Comparer>, &state, threads);
+  }
+  free(buffer, length);
+}
+
 template <typename Element, typename Alloc>
 template <typename Comparer>
 Containers::Length Array<Element, Alloc>::binarySearch(Element const& element, Length const first,
@@ -748,64 +1195,377 @@ Containers::Length Array<Element, Alloc>::partitionQuickSort(Length const first,
 }
 
 template <typename Element, typename Alloc>
-template <typename ElementAssign>
-bool Array<Element, Alloc>::elementInsert(Length index, ElementAssign const& elementAssign)
+template <typename Comparer>
+void Array<Element, Alloc>::introSort(Length first, Length last, Length depthLimit, bool leftmost,
+  Comparer const& comparer)
 {
-  if (Length const length = this->length(); length < MaxLength)
+  while (last - first >= InsertionSortThreshold)
   {
-    index = math::saturate<Length>(index, 0, length);
-    Length const capacity = this->capacity();
+    if (depthLimit-- <= 0)
+    { // Too many unbalanced partitions, switch to algorithm with guaranteed complexity.
+      heapSort(first, last, comparer);
+      return;
+    }
+    selectPivot(first, last, comparer);
+
+    if (!leftmost && comparer(_data[first - 1], _data[first]) >= 0)
+    { // Pivot equals the preceding element (a previous pivot), so the range has no smaller elements and
+      // likely many equal ones, which three-way partitioning puts into their final place at once.
+      Length lower, upper;
+      partitionThreeWay(first, last, lower, upper, comparer);
+      first = upper + 1;
+      continue;
+    }
+    Length const split = partitionTwoWay(first, last, comparer);
 
-    if (length + 1 <= capacity)
-    { // There is enough space to insert element without reallocation
-      for (Length i = length; i > index; --i)
-      {
-        new (_data + i) Element(static_cast<Element&&>(_data[i - 1]));
-        _data[i - 1].~Element();
-      }
-      elementAssign(_data + index);
+    // Recurse into smaller partition and iterate over the bigger one to limit stack depth.
+    if (split - first < last - split)
+    {
+      introSort(first, split - 1, depthLimit, leftmost, comparer);
+      first = split + 1;
+      leftmost = false;
     }
     else
-    { // Reallocate and recombine the array
-      Size const polluteBit = _capacity & PolluteBit;
-      Length const nextCapacity = computeCapacity(length + 1, capacity);
-
-      Element* data = alloc(nextCapacity);
-      if (!data)
-        return false; // Memory allocation failure
-
-      for (Length i = 0; i < index; ++i)
-      {
-        new (data + i) Element(static_cast<Element&&>(_data[i]));
-        _data[i].~Element();
-      }
-      elementAssign(data + index);
-
-      for (Length i = index; i < length; ++i)
-      {
-        new (data + i + 1) Element(static_cast<Element&&>(_data[i]));
-        _data[i].~Element();
-      }
-      free(_data, capacity);
-      _data = data;
-      _capacity = static_cast<Size>(nextCapacity) | polluteBit;
+    {
+      introSort(split + 1, last, depthLimit, false, comparer);
+      last = split - 1;
     }
-    _length = static_cast<Size>(length + 1);
-    return true;
   }
-  else
-    return false; // Overflow
+  if (first < last)
+    insertionSort(first, last, comparer);
 }
 
 template <typename Element, typename Alloc>
-template <typename ElementAssign>
-typename Array<Element, Alloc>::Length Array<Element, Alloc>::elementAdd(ElementAssign const& elementAssign)
-{
-  if (Length const length = this->length(); length < MaxLength)
-  {
-    if (capacity(length + 1))
-    {
-      elementAssign(_data + length);
+template <typename Comparer>
+void Array<Element, Alloc>::selectPivot(Length const first, Length const last, Comparer const& comparer)
+{
+  Length const middle = first + (last - first) / 2;
+
+  // Ordering the first, middle and last elements moves the biggest element, which partitioning of a reversed
+  // run leaves at the front, to the back. Otherwise, elements are only compared to keep sorted runs intact.
+  sortThree(first, middle, last, comparer);
+  Length pivot = middle;
+
+  if (last - first > NintherThreshold)
+  { // Use pseudo-median of nine elements (Tukey's ninther).
+    Length const step = (last - first) / 8;
+    pivot = medianOfThree(
+      medianOfThree(first, first + step, first + step * 2, comparer),
+      medianOfThree(middle - step, middle, middle + step, comparer),
+      medianOfThree(last - step * 2, last - step, last, comparer), comparer);
+  }
+  if (pivot != first)
+    swap(first, pivot);
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::sortThree(Length const first, Length const second, Length const third,
+  Comparer const& comparer)
+{
+  if (comparer(_data[second], _data[first]) < 0)
+    swap(first, second);
+
+  if (comparer(_data[third], _data[second]) < 0)
+  {
+    swap(second, third);
+    if (comparer(_data[second], _data[first]) < 0)
+      swap(first, second);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+Containers::Length Array<Element, Alloc>::medianOfThree(Length const first, Length const second,
+  Length const third, Comparer const& comparer)
+{
+  if (comparer(_data[first], _data[second]) < 0)
+  {
+    if (comparer(_data[second], _data[third]) < 0)
+      return second;
+    return comparer(_data[first], _data[third]) < 0 ? third : first;
+  }
+  if (comparer(_data[first], _data[third]) < 0)
+    return first;
+  return comparer(_data[second], _data[third]) < 0 ? third : second;
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+Containers::Length Array<Element, Alloc>::partitionTwoWay(Length const first, Length const last,
+  Comparer const& comparer)
+{
+  Length left = first, right = last + 1;
+  Element const& pivot = _data[first];
+
+  for (;;)
+  {
+    // Both scans stop at elements equal to pivot, which keeps partitions balanced on duplicates.
+    do
+      ++left;
+    while (left < last && comparer(_data[left], pivot) < 0);
+
+    do
+      --right;
+    while (comparer(pivot, _data[right]) < 0); // Stops at pivot itself.
+
+    if (left >= right)
+      break;
+
+    swap(left, right);
+  }
+  if (first != right)
+    swap(first, right);
+
+  return right;
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::partitionThreeWay(Length const first, Length const last, Length& lower,
+  Length& upper, Comparer const& comparer)
+{
+  // Elements in [first + 1, less) are smaller than pivot, elements in (greater, last] are bigger.
+  Length less = first + 1, greater = last;
+  Element const& pivot = _data[first];
+
+  for (Length i = first + 1; i <= greater; )
+  {
+    auto const res = comparer(_data[i], pivot);
+
+    if (res < 0)
+    {
+      if (less != i)
+        swap(less, i);
+      ++less;
+      ++i;
+    }
+    else if (res > 0)
+    {
+      if (i != greater)
+        swap(i, greater);
+      --greater;
+    }
+    else
+      ++i;
+  }
+  lower = less - 1;
+  upper = greater;
+
+  if (first != lower)
+    swap(first, lower); // Put pivot in front of elements that are equal to it.
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::insertionSort(Length const first, Length const last, Comparer const& comparer)
+{
+  for (Length i = first + 1; i <= last; ++i)
+    if (comparer(_data[i], _data[i - 1]) < 0)
+    {
+      alignas(Element) char buffer[sizeof(Element)];
+      Element* const temp = new (buffer) Element(static_cast<Element&&>(_data[i]));
+
+      Length j = i;
+      do {
+        _data[j] = static_cast<Element&&>(_data[j - 1]);
+        --j;
+      } while (j > first && comparer(*temp, _data[j - 1]) < 0);
+
+      _data[j] = static_cast<Element&&>(*temp);
+      temp->~Element();
+    }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::parallelSortChunk(void* const context, int32_t const index)
+{
+  ParallelSort<Comparer> const& state = *static_cast<ParallelSort<Comparer> const*>(context);
+  Length const first = state.bounds[index], last = state.bounds[index + 1] - 1;
+
+  if (first < last)
+    state.array->introSort(first, last, 2 * math::log2(static_cast<uint64_t>(last - first + 1)), true,
+      *state.comparer);
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::parallelSplit(ParallelSort<Comparer>& state)
+{
+  // Each merge of two runs is split into segments of equal length, so that all threads have work even when
+  // there are only a few runs left. Odd run at the end is merged with an empty one.
+  int32_t const merges = (state.runs + 1) / 2;
+  state.segments = math::max(state.threads / merges, 1);
+
+  for (int32_t task = 0; task < merges * state.segments; ++task)
+  {
+    int32_t const merge = task / state.segments, segment = task % state.segments;
+
+    Length const start = state.bounds[merge * 2];
+    Length const middle = state.bounds[math::min(merge * 2 + 1, state.runs)];
+    Length const end = state.bounds[math::min(merge * 2 + 2, state.runs)];
+
+    state.splits[task] = mergeSplit(state.source + start, middle - start, state.source + middle, end - middle,
+      (end - start) * segment / state.segments, *state.comparer);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::parallelMerge(void* const context, int32_t const index)
+{
+  ParallelSort<Comparer> const& state = *static_cast<ParallelSort<Comparer> const*>(context);
+  Comparer const& comparer = *state.comparer;
+
+  int32_t const merges = (state.runs + 1) / 2;
+
+  for (int32_t task = index; task < merges * state.segments; task += state.threads)
+  {
+    int32_t const merge = task / state.segments, segment = task % state.segments;
+
+    Length const start = state.bounds[merge * 2];
+    Length const middle = state.bounds[math::min(merge * 2 + 1, state.runs)];
+    Length const end = state.bounds[math::min(merge * 2 + 2, state.runs)];
+
+    Element* const left = state.source + start;
+    Element* const right = state.source + middle;
+
+    Length const from = (end - start) * segment / state.segments;
+    Length const to = (end - start) * (segment + 1) / state.segments;
+
+    Length i = state.splits[task];
+    Length j = from - i;
+
+    Length const leftEnd = segment + 1 < state.segments ? state.splits[task + 1] : middle - start;
+    Length const rightEnd = to - leftEnd;
+
+    Element* dest = state.dest + start + from;
+
+    while (i < leftEnd && j < rightEnd)
+    {
+      Element* const element = comparer(right[j], left[i]) < 0 ? right + j++ : left + i++;
+      new (dest++) Element(static_cast<Element&&>(*element));
+      element->~Element();
+    }
+    relocate(dest, left + i, leftEnd - i);
+    relocate(dest + (leftEnd - i), right + j, rightEnd - j);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::parallelMove(void* const context, int32_t const index)
+{
+  ParallelSort<Comparer> const& state = *static_cast<ParallelSort<Comparer> const*>(context);
+  Length const length = state.bounds[1];
+
+  Length const from = length * index / state.threads;
+  Length const to = length * (index + 1) / state.threads;
+
+  relocate(state.dest + from, state.source + from, to - from);
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+Containers::Length Array<Element, Alloc>::mergeSplit(Element const* const left, Length const leftLength,
+  Element const* const right, Length const rightLength, Length const count, Comparer const& comparer)
+{
+  Length low = math::max<Length>(count - rightLength, 0), high = math::min(count, leftLength);
+
+  // Find the smallest number of elements from the left run, after which the next left element is bigger
+  // than the last one taken from the right run.
+  while (low < high)
+  {
+    Length const taken = low + (high - low) / 2;
+
+    if (comparer(right[count - taken - 1], left[taken]) < 0)
+      high = taken;
+    else
+      low = taken + 1;
+  }
+  return low;
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::heapSort(Length const first, Length const last, Comparer const& comparer)
+{
+  Length const count = last - first + 1;
+
+  for (Length i = count / 2; i-- > 0; )
+    siftDown(first, i, count, comparer);
+
+  for (Length end = count - 1; end > 0; --end)
+  {
+    swap(first, first + end);
+    siftDown(first, 0, end, comparer);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename Comparer>
+void Array<Element, Alloc>::siftDown(Length const first, Length root, Length const count,
+  Comparer const& comparer)
+{
+  for (Length child; (child = root * 2 + 1) < count; root = child)
+  {
+    if (child + 1 < count && comparer(_data[first + child], _data[first + child + 1]) < 0)
+      ++child;
+
+    if (comparer(_data[first + root], _data[first + child]) >= 0)
+      break; // Heap property is satisfied.
+
+    swap(first + root, first + child);
+  }
+}
+
+template <typename Element, typename Alloc>
+template <typename ElementAssign>
+bool Array<Element, Alloc>::elementInsert(Length index, ElementAssign const& elementAssign)
+{
+  if (Length const length = this->length(); length < MaxLength)
+  {
+    index = math::saturate<Length>(index, 0, length);
+    Length const capacity = this->capacity();
+
+    if (length + 1 <= capacity)
+    { // There is enough space to insert element without reallocation
+      relocate(_data + index + 1, _data + index, length - index);
+      elementAssign(_data + index);
+    }
+    else
+    { // Reallocate and recombine the array
+      Size const polluteBit = _capacity & PolluteBit;
+      Length const nextCapacity = computeCapacity(length + 1, capacity);
+
+      Element* data = alloc(nextCapacity);
+      if (!data)
+        return false; // Memory allocation failure
+
+      relocate(data, _data, index);
+      elementAssign(data + index);
+      relocate(data + index + 1, _data + index, length - index);
+      free(_data, capacity);
+      _data = data;
+      _capacity = static_cast<Size>(nextCapacity) | polluteBit;
+    }
+    _length = static_cast<Size>(length + 1);
+    return true;
+  }
+  else
+    return false; // Overflow
+}
+
+template <typename Element, typename Alloc>
+template <typename ElementAssign>
+typename Array<Element, Alloc>::Length Array<Element, Alloc>::elementAdd(ElementAssign const& elementAssign)
+{
+  if (Length const length = this->length(); length < MaxLength)
+  {
+    if (capacity(length + 1))
+    {
+      elementAssign(_data + length);
       _length = static_cast<Size>(length + 1);
       return length;
     }
@@ -826,628 +1586,3150 @@ bool Array<Element, Alloc>::reallocate(Length const capacity)
 
   if (Element* data = alloc(capacity))
   {
-    Length const length = this->length();
+    relocate(data, _data, this->length());
+    free(_data, capacityPrev);
+    _data = data;
+    _capacity = static_cast<Size>(capacity) | polluteBit;
+    return true;
+  }
+  else
+    return false; // Memory allocation failure
+}
+
+template <typename Element, typename Alloc>
+void Array<Element, Alloc>::deallocate()
+{
+  for (Length i = length(); i--; )
+    _data[i].~Element();
+
+  free(_data, capacity());
+}
+
+template <typename Element, typename Alloc>
+void Array<Element, Alloc>::relocate(Element* const dest, Element* const source, Length const count) noexcept
+{
+  if constexpr (utility::TriviallyRelocatable<Element>::value)
+  {
+    if (count > 0)
+      memmove(static_cast<void*>(dest), static_cast<void const*>(source),
+        static_cast<size_t>(count) * sizeof(Element));
+  }
+  else if (dest < source)
+  {
+    for (Length i = 0; i < count; ++i)
+    {
+      new (dest + i) Element(static_cast<Element&&>(source[i]));
+      source[i].~Element();
+    }
+  }
+  else
+  {
+    for (Length i = count; i-- > 0; )
+    {
+      new (dest + i) Element(static_cast<Element&&>(source[i]));
+      source[i].~Element();
+    }
+  }
+}
+
+template <typename Element, typename Alloc>
+Element* Array<Element, Alloc>::alloc(Length const count)
+{
+  return static_cast<Element*>(_alloc.alloc(static_cast<size_t>(count) * sizeof(Element), alignof(Element)));
+}
+
+template <typename Element, typename Alloc>
+void Array<Element, Alloc>::free(Element* const data, Length const count)
+{
+  _alloc.free(data, static_cast<size_t>(count) * sizeof(Element), alignof(Element));
+}
+
+// PairStorage<Key, Value, Alloc> members.
+
+template <typename Key, typename Value, typename Alloc>
+PairStorage<Key, Value, Alloc>::PairStorage(Alloc&& alloc) noexcept
+: _pairs(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Key, typename Value, typename Alloc>
+typename PairStorage<Key, Value, Alloc>::KeyValue const* PairStorage<Key, Value, Alloc>::data() const noexcept
+{
+  return _pairs.data();
+}
+
+template <typename Key, typename Value, typename Alloc>
+typename PairStorage<Key, Value, Alloc>::KeyValue* PairStorage<Key, Value, Alloc>::data() noexcept
+{
+  return _pairs.data();
+}
+
+template <typename Key, typename Value, typename Alloc>
+PairStorage<Key, Value, Alloc>::operator bool () const noexcept
+{
+  return static_cast<bool>(_pairs);
+}
+
+template <typename Key, typename Value, typename Alloc>
+Alloc const& PairStorage<Key, Value, Alloc>::allocator() const noexcept
+{
+  return _pairs.allocator();
+}
+
+template <typename Key, typename Value, typename Alloc>
+Containers::Length PairStorage<Key, Value, Alloc>::capacity() const noexcept
+{
+  return _pairs.capacity();
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool PairStorage<Key, Value, Alloc>::capacity(Length const capacity)
+{
+  return _pairs.capacity(capacity);
+}
+
+template <typename Key, typename Value, typename Alloc>
+Containers::Length PairStorage<Key, Value, Alloc>::length() const noexcept
+{
+  return _pairs.length();
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename PairsConstruct>
+bool PairStorage<Key, Value, Alloc>::expand(Length const count, PairsConstruct const& pairsConstruct)
+{
+  return _pairs.expand(count, [&pairsConstruct](KeyValue*) { pairsConstruct(); });
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::clear() noexcept
+{
+  _pairs.clear();
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool PairStorage<Key, Value, Alloc>::shrink() noexcept
+{
+  return _pairs.shrink();
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::purge() noexcept
+{
+  _pairs.purge();
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool PairStorage<Key, Value, Alloc>::empty() const noexcept
+{
+  return _pairs.empty();
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::pollute() noexcept
+{
+  _pairs.pollute();
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::unpollute() noexcept
+{
+  _pairs.unpollute();
+}
+
+template <typename Key, typename Value, typename Alloc>
+Key const& PairStorage<Key, Value, Alloc>::key(Length const index) const noexcept
+{
+  return _pairs[index].key;
+}
+
+template <typename Key, typename Value, typename Alloc>
+Value const& PairStorage<Key, Value, Alloc>::value(Length const index) const noexcept
+{
+  return _pairs[index].value;
+}
+
+template <typename Key, typename Value, typename Alloc>
+Value& PairStorage<Key, Value, Alloc>::value(Length const index) noexcept
+{
+  return _pairs[index].value;
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename KeyType, typename ValueType>
+bool PairStorage<Key, Value, Alloc>::insert(Length const index, KeyType&& key, ValueType&& value)
+{
+  return _pairs.insert(index, KeyValue(static_cast<KeyType&&>(key), static_cast<ValueType&&>(value)));
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool PairStorage<Key, Value, Alloc>::erase(Length const index) noexcept
+{
+  return _pairs.erase(index);
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::move(Length const dest, Length const source) noexcept
+{
+  _pairs[dest] = static_cast<KeyValue&&>(_pairs[source]);
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Source>
+void PairStorage<Key, Value, Alloc>::assign(Length const index, Source&& pair)
+{
+  _pairs[index] = static_cast<Source&&>(pair);
+}
+
+template <typename Key, typename Value, typename Alloc>
+void PairStorage<Key, Value, Alloc>::moveConstruct(Length const dest, Length const source) noexcept
+{
+  new (_pairs.data() + dest) KeyValue(static_cast<KeyValue&&>(_pairs[source]));
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Source>
+void PairStorage<Key, Value, Alloc>::construct(Length const index, Source&& pair)
+{
+  new (_pairs.data() + index) KeyValue(static_cast<Source&&>(pair));
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Comparer>
+auto PairStorage<Key, Value, Alloc>::PairComparer<Comparer>::operator () (KeyValue const& pair,
+  Key const& key) const
+{
+  return comparer(pair.key, key);
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Comparer>
+bool PairStorage<Key, Value, Alloc>::search(Length& index, Key const& key, Comparer const& comparer) const noexcept
+{
+  return searchSorted(index, _pairs.data(), _pairs.length(), key, PairComparer<Comparer>{comparer});
+}
+
+// SplitStorage<Key, Value, Alloc> members.
+
+template <typename Key, typename Value, typename Alloc>
+SplitStorage<Key, Value, Alloc>::SplitStorage(Alloc&& alloc) noexcept
+: _keys(Alloc(alloc)),
+  _values(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Key, typename Value, typename Alloc>
+SplitStorage<Key, Value, Alloc>::SplitStorage(SplitStorage const& storage)
+: _keys(storage._keys),
+  _values(storage._values)
+{
+  // Keys without values (or vice versa) would break the storage, so a partial copy is discarded.
+  if (!_keys || !_values)
+  {
+    purge();
+    pollute();
+  }
+}
+
+template <typename Key, typename Value, typename Alloc>
+SplitStorage<Key, Value, Alloc>& SplitStorage<Key, Value, Alloc>::operator = (SplitStorage const& storage)
+{
+  assert(this != &storage);
+
+  _keys = storage._keys;
+  _values = storage._values;
+
+  if (!_keys || !_values)
+  {
+    purge();
+    pollute();
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename Alloc>
+SplitStorage<Key, Value, Alloc>::operator bool () const noexcept
+{
+  return _keys && _values;
+}
+
+template <typename Key, typename Value, typename Alloc>
+Alloc const& SplitStorage<Key, Value, Alloc>::allocator() const noexcept
+{
+  return _keys.allocator();
+}
+
+template <typename Key, typename Value, typename Alloc>
+Containers::Length SplitStorage<Key, Value, Alloc>::capacity() const noexcept
+{
+  return math::min(_keys.capacity(), _values.capacity());
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool SplitStorage<Key, Value, Alloc>::capacity(Length const capacity)
+{
+  return _keys.capacity(capacity) && _values.capacity(capacity);
+}
+
+template <typename Key, typename Value, typename Alloc>
+Containers::Length SplitStorage<Key, Value, Alloc>::length() const noexcept
+{
+  return _keys.length();
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename PairsConstruct>
+bool SplitStorage<Key, Value, Alloc>::expand(Length const count, PairsConstruct const& pairsConstruct)
+{
+  // Reserving memory for both arrays first ensures that they are either both expanded, or neither is.
+  Length const length = _keys.length();
+
+  return length <= MaxLength - count && capacity(length + count) &&
+    _keys.expand(count, [this, count, &pairsConstruct](Key*)
+    {
+      static_cast<void>(_values.expand(count, [&pairsConstruct](Value*) { pairsConstruct(); }));
+    });
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::clear() noexcept
+{
+  _keys.clear();
+  _values.clear();
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool SplitStorage<Key, Value, Alloc>::shrink() noexcept
+{
+  bool const keysShrunk = _keys.shrink();
+  return _values.shrink() && keysShrunk;
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::purge() noexcept
+{
+  _keys.purge();
+  _values.purge();
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool SplitStorage<Key, Value, Alloc>::empty() const noexcept
+{
+  return _keys.empty();
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::pollute() noexcept
+{
+  _keys.pollute();
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::unpollute() noexcept
+{
+  _keys.unpollute();
+  _values.unpollute();
+}
+
+template <typename Key, typename Value, typename Alloc>
+Key const& SplitStorage<Key, Value, Alloc>::key(Length const index) const noexcept
+{
+  return _keys[index];
+}
+
+template <typename Key, typename Value, typename Alloc>
+Value const& SplitStorage<Key, Value, Alloc>::value(Length const index) const noexcept
+{
+  return _values[index];
+}
+
+template <typename Key, typename Value, typename Alloc>
+Value& SplitStorage<Key, Value, Alloc>::value(Length const index) noexcept
+{
+  return _values[index];
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename KeyType, typename ValueType>
+bool SplitStorage<Key, Value, Alloc>::insert(Length const index, KeyType&& key, ValueType&& value)
+{
+  // Reserving memory for both arrays first ensures that inserting the value cannot fail after the key has
+  // already been inserted.
+  Length const length = _keys.length();
+
+  return length < MaxLength && capacity(length + 1) && _keys.insert(index, static_cast<KeyType&&>(key)) &&
+    _values.insert(index, static_cast<ValueType&&>(value));
+}
+
+template <typename Key, typename Value, typename Alloc>
+bool SplitStorage<Key, Value, Alloc>::erase(Length const index) noexcept
+{
+  return _keys.erase(index) && _values.erase(index);
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::move(Length const dest, Length const source) noexcept
+{
+  _keys[dest] = static_cast<Key&&>(_keys[source]);
+  _values[dest] = static_cast<Value&&>(_values[source]);
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Source>
+void SplitStorage<Key, Value, Alloc>::assign(Length const index, Source&& pair)
+{
+  _keys[index] = static_cast<Source&&>(pair).key;
+  _values[index] = static_cast<Source&&>(pair).value;
+}
+
+template <typename Key, typename Value, typename Alloc>
+void SplitStorage<Key, Value, Alloc>::moveConstruct(Length const dest, Length const source) noexcept
+{
+  new (_keys.data() + dest) Key(static_cast<Key&&>(_keys[source]));
+  new (_values.data() + dest) Value(static_cast<Value&&>(_values[source]));
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Source>
+void SplitStorage<Key, Value, Alloc>::construct(Length const index, Source&& pair)
+{
+  new (_keys.data() + index) Key(static_cast<Source&&>(pair).key);
+  new (_values.data() + index) Value(static_cast<Source&&>(pair).value);
+}
+
+template <typename Key, typename Value, typename Alloc>
+template <typename Comparer>
+bool SplitStorage<Key, Value, Alloc>::search(Length& index, Key const& key, Comparer const& comparer) const noexcept
+{
+  return searchSorted(index, _keys.data(), _keys.length(), key, comparer);
+}
+
+// FlatMap<Key, Value, Comparer, Alloc, Storage> members.
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>::FlatMap(Comparer&& comparer, Alloc&& alloc) noexcept
+: _storage(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>::FlatMap(std::initializer_list<KeyValue> const pairs,
+  Comparer&& comparer, Alloc&& alloc) noexcept
+: _storage(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+  if (!addRange(pairs))
+    pollute();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+template <typename ArrayAlloc>
+FlatMap<Key, Value, Comparer, Alloc, Storage>::FlatMap(Array<KeyValue, ArrayAlloc> const& pairs, Comparer&& comparer,
+  Alloc&& alloc) noexcept
+: _storage(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+  if (!addRange(pairs))
+    pollute();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::KeyValue const& FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::operator [] (Location const& location) const noexcept
+{
+  return _storage.data()[location.index()];
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::KeyValue const* FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::begin() const noexcept
+{
+  return _storage.data();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::KeyValue const* FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::end() const noexcept
+{
+  return _storage.data() + _storage.length();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::KeyValue const& FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::first() const noexcept
+{
+  return _storage.data()[0];
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::KeyValue const& FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::last() const noexcept
+{
+  return _storage.data()[_storage.length() - 1];
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>::operator bool () const noexcept
+{
+  return static_cast<bool>(_storage);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::Length FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::capacity() const noexcept
+{
+  return _storage.capacity();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::capacity(Length const capacity)
+{
+  return _storage.capacity(capacity);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+typename FlatMap<Key, Value, Comparer, Alloc, Storage>::Length FlatMap<Key, Value, Comparer,
+  Alloc, Storage>::length() const noexcept
+{
+  return _storage.length();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+void FlatMap<Key, Value, Comparer, Alloc, Storage>::clear() noexcept
+{
+  _storage.clear();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::shrink() noexcept
+{
+  return _storage.shrink();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+void FlatMap<Key, Value, Comparer, Alloc, Storage>::purge() noexcept
+{
+  _storage.purge();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::exists(Key const& key) const noexcept
+{
+  Length index;
+  return search(index, key);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Containers::Location FlatMap<Key, Value, Comparer, Alloc, Storage>::add(Key const& key, Value const& value)
+{
+  Length index;
+  if (search(index, key))
+    _storage.value(index) = value;
+  else if (!_storage.insert(index, key, value))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Containers::Location FlatMap<Key, Value, Comparer, Alloc, Storage>::add(Key const& key, Value&& value)
+{
+  Length index;
+  if (search(index, key))
+    _storage.value(index) = static_cast<Value&&>(value);
+  else if (!_storage.insert(index, key, static_cast<Value&&>(value)))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Containers::Location FlatMap<Key, Value, Comparer, Alloc, Storage>::add(Key&& key, Value const& value)
+{
+  Length index;
+  if (search(index, key))
+    _storage.value(index) = value;
+  else if (!_storage.insert(index, static_cast<Key&&>(key), value))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Containers::Location FlatMap<Key, Value, Comparer, Alloc, Storage>::add(Key&& key, Value&& value)
+{
+  Length index;
+  if (search(index, key))
+    _storage.value(index) = static_cast<Value&&>(value);
+  else if (!_storage.insert(index, static_cast<Key&&>(key), static_cast<Value&&>(value)))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::insert(Location const& location, Key const& key,
+  Value const& value)
+{
+  return _storage.insert(location.index(), key, value);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::insert(Location const& location, Key const& key, Value&& value)
+{
+  return _storage.insert(location.index(), key, static_cast<Value&&>(value));
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::insert(Location const& location, Key&& key, Value const& value)
+{
+  return _storage.insert(location.index(), static_cast<Key&&>(key), value);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::insert(Location const& location, Key&& key, Value&& value)
+{
+  return _storage.insert(location.index(), static_cast<Key&&>(key), static_cast<Value&&>(value));
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::addp(Key const& key,
+  Value const& value)
+{
+  if (!add(key, value))
+    pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::addp(Key const& key,
+  Value&& value)
+{
+  if (!add(key, static_cast<Value&&>(value)))
+    pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::addp(Key&& key,
+  Value const& value)
+{
+  if (!add(static_cast<Key&&>(key), value))
+    pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::addp(Key&& key,
+  Value&& value)
+{
+  if (!add(static_cast<Key&&>(key), static_cast<Value&&>(value)))
+    pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::addRange(KeyValue const* const pairs, Length const count,
+  Duplicates const duplicates)
+{
+  return mergeRange(pairs, count, duplicates);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::addRange(std::initializer_list<KeyValue> const pairs,
+  Duplicates const duplicates)
+{
+  return pairs.size() <= static_cast<size_t>(MaxLength) &&
+    mergeRange(pairs.begin(), static_cast<Length>(pairs.size()), duplicates);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+template <typename ArrayAlloc>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::addRange(Array<KeyValue, ArrayAlloc> const& pairs,
+  Duplicates const duplicates)
+{
+  return mergeRange(pairs.data(), pairs.length(), duplicates);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+template <typename ArrayAlloc>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::addRange(Array<KeyValue, ArrayAlloc>&& pairs,
+  Duplicates const duplicates)
+{
+  if (mergeRange(pairs.data(), pairs.length(), duplicates))
+  {
+    pairs.clear();
+    return true;
+  }
+  else
+    return false;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::erase(Key const& key) noexcept
+{
+  Length index;
+  if (search(index, key))
+    return _storage.erase(index);
+  else
+    return false; // Key does not exist.
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::erase(Location const& location) noexcept
+{
+  return location ? _storage.erase(location.index()) : false;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Value const* FlatMap<Key, Value, Comparer, Alloc, Storage>::value(Key const& key) const noexcept
+{
+  Length index;
+  return search(index, key) ? &_storage.value(index) : nullptr;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Value* FlatMap<Key, Value, Comparer, Alloc, Storage>::value(Key const& key) noexcept
+{
+  Length index;
+  return search(index, key) ? &_storage.value(index) : nullptr;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Key const& FlatMap<Key, Value, Comparer, Alloc, Storage>::key(Location const& location) const noexcept
+{
+  return _storage.key(location.index());
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Value const& FlatMap<Key, Value, Comparer, Alloc, Storage>::at(Location const& location) const noexcept
+{
+  return _storage.value(location.index());
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Value& FlatMap<Key, Value, Comparer, Alloc, Storage>::at(Location const& location) noexcept
+{
+  return _storage.value(location.index());
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+Containers::Location FlatMap<Key, Value, Comparer, Alloc, Storage>::find(Key const& key) const noexcept
+{
+  Length index;
+  return search(index, key) ? Location(index) : Location(NotFound);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::find(Location& location, Key const& key) const noexcept
+{
+  Length index;
+  bool const found = search(index, key);
+  location = Location(index);
+  return found;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::empty() const noexcept
+{
+  return _storage.empty();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::pollute() noexcept
+{
+  _storage.pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+FlatMap<Key, Value, Comparer, Alloc, Storage>& FlatMap<Key, Value, Comparer, Alloc, Storage>::unpollute() noexcept
+{
+  _storage.unpollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::search(Length& index, Key const& key) const noexcept
+{
+  return _storage.search(index, key, _comparer);
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc, typename Storage>
+template <typename Source>
+bool FlatMap<Key, Value, Comparer, Alloc, Storage>::mergeRange(Source* const pairs, Length const count,
+  Duplicates const duplicates)
+{
+  if (count <= 0)
+    return !count;
+
+  // Sort indices of new pairs by key, so that pairs themselves are not moved around. Equal keys remain in
+  // their original order to apply duplicate policy.
+  Array<Length, Alloc> order(static_cast<Alloc&&>(Alloc(_storage.allocator())));
+  if (!order.length(count))
+    return false; // Memory allocation failure
+
+  for (Length i = 0; i < count; ++i)
+    order[i] = i;
+
+  order.sort(0, MaxLength, [this, pairs](Length const left, Length const right)
+  {
+    auto const res = _comparer(pairs[left].key, pairs[right].key);
+    return res < 0 ? -1 : (res > 0 ? 1 : (left < right ? -1 : (left > right ? 1 : 0)));
+  });
+
+  // Remove duplicate keys among new pairs.
+  Length unique = 0;
+
+  for (Length i = 0; i < count; ++i)
+    if (!unique || _comparer(pairs[order[unique - 1]].key, pairs[order[i]].key) != 0)
+      order[unique++] = order[i];
+    else if (duplicates == Duplicates::KeepLast)
+      order[unique - 1] = order[i];
+
+  // Count keys that already exist in the container.
+  Length const length = _storage.length();
+  Length matches = 0;
+
+  for (Length i = 0, j = 0; i < length && j < unique; )
+  {
+    auto const res = _comparer(_storage.key(i), pairs[order[j]].key);
+
+    if (res < 0)
+      ++i;
+    else if (res > 0)
+      ++j;
+    else
+    {
+      ++matches;
+      ++i;
+      ++j;
+    }
+  }
+  if (unique - matches > MaxLength - length)
+    return false; // Overflow
+
+  // Merge from the back, so that existing pairs are moved at most once. Pairs past the current length are
+  // uninitialized, so they are constructed rather than assigned.
+  return _storage.expand(unique - matches, [&]()
+  {
+    Length dest = length + unique - matches;
+
+    for (Length i = length - 1, j = unique - 1; j >= 0; )
+    {
+      Source& pair = pairs[order[j]];
+      auto const res = i >= 0 ? _comparer(_storage.key(i), pair.key) : -1;
+
+      if (res >= 0)
+      {
+        if (res == 0)
+        {
+          if (duplicates == Duplicates::KeepLast)
+            _storage.value(i) = static_cast<Source&&>(pair).value;
+          --j;
+        }
+        if (--dest >= length)
+          _storage.moveConstruct(dest, i);
+        else if (dest != i)
+          _storage.move(dest, i);
+        --i;
+      }
+      else
+      {
+        if (--dest >= length)
+          _storage.construct(dest, static_cast<Source&&>(pair));
+        else
+          _storage.assign(dest, static_cast<Source&&>(pair));
+        --j;
+      }
+    }
+  });
+}
+
+// FlatSet<Value, Comparer> members.
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>::FlatSet(Comparer&& comparer, Alloc&& alloc) noexcept
+: _values(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>::FlatSet(std::initializer_list<Value> const values, Comparer&& comparer,
+  Alloc&& alloc)
+: _values(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+  if (!addRange(values))
+    pollute();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename ArrayAlloc>
+FlatSet<Value, Comparer, Alloc>::FlatSet(Array<Value, ArrayAlloc> const& values, Comparer&& comparer,
+  Alloc&& alloc)
+: _values(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+  if (!addRange(values))
+    pollute();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+Value const& FlatSet<Value, Comparer, Alloc>::operator [] (Location const& location) const noexcept
+{
+  return _values[location.index()];
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+Value const* FlatSet<Value, Comparer, Alloc>::begin() const noexcept
+{
+  return _values.begin();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+Value const* FlatSet<Value, Comparer, Alloc>::end() const noexcept
+{
+  return _values.end();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>::operator bool () const noexcept
+{
+  return static_cast<bool>(_values);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+typename FlatSet<Value, Comparer, Alloc>::Length FlatSet<Value, Comparer, Alloc>::capacity() const noexcept
+{
+  return _values.capacity();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::capacity(Length const capacity)
+{
+  return _values.capacity(capacity);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+typename FlatSet<Value, Comparer, Alloc>::Length FlatSet<Value, Comparer, Alloc>::length() const noexcept
+{
+  return _values.length();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+void FlatSet<Value, Comparer, Alloc>::clear() noexcept
+{
+  _values.clear();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::shrink() noexcept
+{
+  return _values.shrink();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+void FlatSet<Value, Comparer, Alloc>::purge() noexcept
+{
+  _values.clear();
+  static_cast<void>(_values.shrink());
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::exists(Value const& value) const noexcept
+{
+  Length index;
+  return search(index, value);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::add(Value const& value)
+{
+  Length index;
+  if (!search(index, value) && !_values.insert(index, value))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::add(Value&& value)
+{
+  Length index;
+  if (!search(index, value) && !_values.insert(index, static_cast<Value&&>(value)))
+    index = NotFound;
+  return Location(index);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::update(Value const& value)
+{
+  Length index;
+  if (!search(index, value))
+    return _values.insert(index, value);
+  else
+  {
+    _values[index] = value;
+    return true;
+  }
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::update(Value&& value)
+{
+  Length index;
+  if (!search(index, value))
+    return _values.insert(index, static_cast<Value&&>(value));
+  else
+  {
+    _values[index] = static_cast<Value&&>(value);
+    return true;
+  }
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::insert(Location const& location, Value const& value)
+{
+  return _values.insert(location.index(), value);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::insert(Location const& location, Value&& value)
+{
+  return _values.insert(location.index(), static_cast<Value&&>(value));
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::addp(Value const& value)
+{
+  if (!add(value))
+    pollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::addp(Value&& value)
+{
+  if (!add(static_cast<Value&&>(value)))
+    pollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::addRange(Value const* const values, Length const count,
+  Duplicates const duplicates)
+{
+  return mergeRange(values, count, duplicates);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::addRange(std::initializer_list<Value> const values,
+  Duplicates const duplicates)
+{
+  return values.size() <= static_cast<size_t>(MaxLength) &&
+    mergeRange(values.begin(), static_cast<Length>(values.size()), duplicates);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename ArrayAlloc>
+bool FlatSet<Value, Comparer, Alloc>::addRange(Array<Value, ArrayAlloc> const& values,
+  Duplicates const duplicates)
+{
+  return mergeRange(values.data(), values.length(), duplicates);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename ArrayAlloc>
+bool FlatSet<Value, Comparer, Alloc>::addRange(Array<Value, ArrayAlloc>&& values, Duplicates const duplicates)
+{
+  if (mergeRange(values.data(), values.length(), duplicates))
+  {
+    values.clear();
+    return true;
+  }
+  else
+    return false;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::erase(Value const& value) noexcept
+{
+  Length index;
+  if (search(index, value))
+    return _values.erase(index);
+  else
+    return false; // Value does not exist
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::erase(Location const& location) noexcept
+{
+  return _values.erase(location.index());
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::find(
+  Value const& value) const noexcept
+{
+  Length index;
+  return search(index, value) ? index : NotFound;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::find(Location& index, Value const& value) const noexcept
+{
+  return search(index, value);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::empty() const noexcept
+{
+  return _values.empty();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::pollute() noexcept
+{
+  _values.pollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::unpollute() noexcept
+{
+  _values.unpollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename CustomValue, typename CustomCompare>
+bool FlatSet<Value, Comparer, Alloc>::find(Location& location, CustomValue const& value,
+  CustomCompare const& compare) const
+{
+  Length index;
+  bool const found = searchSorted(index, _values.data(), _values.length(), value, compare);
+  location = Location(index);
+  return found;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+bool FlatSet<Value, Comparer, Alloc>::search(Length& index, Value const& value) const noexcept
+{
+  return searchSorted(index, _values.data(), _values.length(), value, _comparer);
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename Source>
+bool FlatSet<Value, Comparer, Alloc>::mergeRange(Source* const values, Length const count,
+  Duplicates const duplicates)
+{
+  if (count <= 0)
+    return !count;
+
+  // Sort indices of new values, so that values themselves are not moved around. Equal values remain in
+  // their original order to apply duplicate policy.
+  Array<Length, Alloc> order(static_cast<Alloc&&>(Alloc(_values.allocator())));
+  if (!order.length(count))
+    return false; // Memory allocation failure
+
+  for (Length i = 0; i < count; ++i)
+    order[i] = i;
+
+  order.sort(0, MaxLength, [this, values](Length const left, Length const right)
+  {
+    auto const res = _comparer(values[left], values[right]);
+    return res < 0 ? -1 : (res > 0 ? 1 : (left < right ? -1 : (left > right ? 1 : 0)));
+  });
+
+  // Remove duplicates among new values.
+  Length unique = 0;
+
+  for (Length i = 0; i < count; ++i)
+    if (!unique || _comparer(values[order[unique - 1]], values[order[i]]) != 0)
+      order[unique++] = order[i];
+    else if (duplicates == Duplicates::KeepLast)
+      order[unique - 1] = order[i];
+
+  // Count values that already exist in the container.
+  Length const length = _values.length();
+  Length matches = 0;
+
+  for (Length i = 0, j = 0; i < length && j < unique; )
+  {
+    auto const res = _comparer(_values[i], values[order[j]]);
+
+    if (res < 0)
+      ++i;
+    else if (res > 0)
+      ++j;
+    else
+    {
+      ++matches;
+      ++i;
+      ++j;
+    }
+  }
+  if (unique - matches > MaxLength - length)
+    return false; // Overflow
+
+  // Merge from the back, so that existing values are moved at most once. Values past the current length are
+  // uninitialized, so they are constructed rather than assigned.
+  return _values.expand(unique - matches, [&](Value* const data)
+  {
+    Length dest = length + unique - matches;
+
+    for (Length i = length - 1, j = unique - 1; j >= 0; )
+    {
+      Source& value = values[order[j]];
+      auto const res = i >= 0 ? _comparer(_values[i], value) : -1;
+
+      if (res > 0 || (res == 0 && duplicates == Duplicates::KeepFirst))
+      {
+        if (res == 0)
+          --j;
+        if (--dest >= length)
+          new (data + (dest - length)) Value(static_cast<Value&&>(_values[i]));
+        else if (dest != i)
+          _values[dest] = static_cast<Value&&>(_values[i]);
+        --i;
+      }
+      else
+      {
+        if (res == 0)
+          --i; // Replace existing value.
+        if (--dest >= length)
+          new (data + (dest - length)) Value(static_cast<Source&&>(value));
+        else
+          _values[dest] = static_cast<Source&&>(value);
+        --j;
+      }
+    }
+  });
+}
+
+// EytzingerTree<Key, Comparer, Alloc> members.
+
+template <typename Key, typename Comparer, typename Alloc>
+EytzingerTree<Key, Comparer, Alloc>::EytzingerTree(Comparer&& comparer, Alloc&& alloc) noexcept
+: _keys(Alloc(alloc)),
+  _order(static_cast<Alloc&&>(alloc)),
+  _comparer(static_cast<Comparer&&>(comparer))
+{
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+EytzingerTree<Key, Comparer, Alloc>::EytzingerTree(EytzingerTree const& tree)
+: _keys(tree._keys),
+  _order(tree._order),
+  _comparer(tree._comparer)
+{
+  if (!_keys || !_order)
+    discard();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+EytzingerTree<Key, Comparer, Alloc>& EytzingerTree<Key, Comparer, Alloc>::operator = (EytzingerTree const& tree)
+{
+  assert(this != &tree);
+
+  _keys = tree._keys;
+  _order = tree._order;
+  _comparer = tree._comparer;
+
+  if (!_keys || !_order)
+    discard();
+
+  return *this;
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Containers::Location const* EytzingerTree<Key, Comparer, Alloc>::begin() const noexcept
+{
+  return _order.begin();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Containers::Location const* EytzingerTree<Key, Comparer, Alloc>::end() const noexcept
+{
+  return _order.end();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+EytzingerTree<Key, Comparer, Alloc>::operator bool () const noexcept
+{
+  return _keys && _order;
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Containers::Length EytzingerTree<Key, Comparer, Alloc>::length() const noexcept
+{
+  return _keys.length();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+bool EytzingerTree<Key, Comparer, Alloc>::empty() const noexcept
+{
+  return _keys.empty();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+bool EytzingerTree<Key, Comparer, Alloc>::exists(Key const& key) const noexcept
+{
+  return search(key) != NotFound;
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Containers::Location EytzingerTree<Key, Comparer, Alloc>::find(Key const& key) const noexcept
+{
+  Length const index = search(key);
+  return index != NotFound ? Location(index) : Location();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Key const& EytzingerTree<Key, Comparer, Alloc>::key(Location const& location) const noexcept
+{
+  return _keys[location.index()];
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+bool EytzingerTree<Key, Comparer, Alloc>::arrange(Array<Length, Alloc>& positions, Length const count)
+{
+  if (!positions.length(count) || !_order.length(count))
+    return false; // Memory allocation failure
+
+  // Visit nodes of the tree in ascending order, where nodes are numbered from one, so that children of node
+  // n are 2n and 2n + 1. Traversal starts at the leftmost node.
+  Length node = 1;
+  while (node * 2 <= count)
+    node *= 2;
+
+  for (Length position = 0; position < count; ++position)
+  {
+    _order[position] = Location(node - 1);
+    positions[node - 1] = position;
+
+    if (node * 2 + 1 <= count)
+    {
+      // Next node is the leftmost one of the right subtree.
+      node = node * 2 + 1;
+      while (node * 2 <= count)
+        node *= 2;
+    }
+    else // Otherwise, go up while the node is a right child, and then once more.
+      node >>= math::countTrailingZeros(~static_cast<uint64_t>(node)) + 1;
+  }
+  return true;
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+void EytzingerTree<Key, Comparer, Alloc>::discard() noexcept
+{
+  _keys.purge();
+  _order.purge();
+  _keys.pollute();
+}
+
+template <typename Key, typename Comparer, typename Alloc>
+Containers::Length EytzingerTree<Key, Comparer, Alloc>::search(Key const& key) const noexcept
+{
+  Key const* const keys = _keys.data();
+  Length const count = _keys.length();
+
+  // Descend from the root, going right after keys that are less than the given one, and left otherwise.
+  Length node = 1;
+
+  while (node <= count)
+  {
+    prefetch(keys + node * PrefetchStride - 1);
+
+    Length const right = _comparer(keys[node - 1], key) < 0;
+    node = node * 2 + right;
+  }
+
+  // The last left turn was made at the first key that is not less than the given one. Trailing ones of the
+  // node number are right turns made since then.
+  node >>= math::countTrailingZeros(~static_cast<uint64_t>(node)) + 1;
+
+  return node && _comparer(keys[node - 1], key) == 0 ? node - 1 : NotFound;
+}
+
+// FrozenFlatMap<Key, Value, Comparer, Alloc> members.
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>::FrozenFlatMap(Comparer&& comparer, Alloc&& alloc) noexcept
+: Tree(static_cast<Comparer&&>(comparer), Alloc(alloc)),
+  _values(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+template <typename MapAlloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>::FrozenFlatMap(FlatMap<Key, Value, Comparer, MapAlloc> const& map,
+  Comparer&& comparer, Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), Alloc(alloc)),
+  _values(static_cast<Alloc&&>(alloc))
+{
+  if (!build(map.begin(), map.length()))
+    pollute();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+template <typename MapAlloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>::FrozenFlatMap(FlatMap<Key, Value, Comparer, MapAlloc>&& map,
+  Comparer&& comparer, Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), Alloc(alloc)),
+  _values(static_cast<Alloc&&>(alloc))
+{
+  if (build(map._storage.data(), map.length()))
+    map.purge();
+  else
+    pollute();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>::FrozenFlatMap(FrozenFlatMap const& map)
+: Tree(map),
+  _values(map._values)
+{
+  if (!*this)
+  {
+    this->discard();
+    _values.purge();
+  }
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>& FrozenFlatMap<Key, Value, Comparer, Alloc>::operator = (
+  FrozenFlatMap const& map)
+{
+  assert(this != &map);
+
+  Tree::operator = (map);
+  _values = map._values;
+
+  if (!*this)
+  {
+    this->discard();
+    _values.purge();
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>::operator bool () const noexcept
+{
+  return Tree::operator bool () && _values;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+void FrozenFlatMap<Key, Value, Comparer, Alloc>::clear() noexcept
+{
+  this->_keys.clear();
+  this->_order.clear();
+  _values.clear();
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+Value const* FrozenFlatMap<Key, Value, Comparer, Alloc>::value(Key const& key) const noexcept
+{
+  Containers::Length const index = this->search(key);
+  return index != Containers::NotFound ? &_values[index] : nullptr;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+Value* FrozenFlatMap<Key, Value, Comparer, Alloc>::value(Key const& key) noexcept
+{
+  Containers::Length const index = this->search(key);
+  return index != Containers::NotFound ? &_values[index] : nullptr;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+Value const& FrozenFlatMap<Key, Value, Comparer, Alloc>::at(Location const& location) const noexcept
+{
+  return _values[location.index()];
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+Value& FrozenFlatMap<Key, Value, Comparer, Alloc>::at(Location const& location) noexcept
+{
+  return _values[location.index()];
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>& FrozenFlatMap<Key, Value, Comparer, Alloc>::pollute() noexcept
+{
+  this->_keys.pollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+FrozenFlatMap<Key, Value, Comparer, Alloc>& FrozenFlatMap<Key, Value, Comparer, Alloc>::unpollute() noexcept
+{
+  this->_keys.unpollute();
+  this->_order.unpollute();
+  _values.unpollute();
+  return *this;
+}
+
+template <typename Key, typename Value, typename Comparer, typename Alloc>
+template <typename Source>
+bool FrozenFlatMap<Key, Value, Comparer, Alloc>::build(Source* const pairs, Containers::Length const count)
+{
+  clear();
+
+  Array<Containers::Length, Alloc> positions(static_cast<Alloc&&>(Alloc(this->_keys.allocator())));
+
+  if (!this->arrange(positions, count) || !this->_keys.capacity(count) || !_values.capacity(count))
+  {
+    clear();
+    return false; // Memory allocation failure
+  }
+
+  for (Containers::Length i = 0; i < count; ++i)
+  {
+    Source& pair = pairs[positions[i]];
+    this->_keys.addp(static_cast<Source&&>(pair).key);
+    _values.addp(static_cast<Source&&>(pair).value);
+  }
+  return true;
+}
+
+// FrozenFlatSet<Value, Comparer, Alloc> members.
+
+template <typename Value, typename Comparer, typename Alloc>
+FrozenFlatSet<Value, Comparer, Alloc>::FrozenFlatSet(Comparer&& comparer, Alloc&& alloc) noexcept
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename SetAlloc>
+FrozenFlatSet<Value, Comparer, Alloc>::FrozenFlatSet(FlatSet<Value, Comparer, SetAlloc> const& set,
+  Comparer&& comparer, Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
+{
+  if (!build(set.begin(), set.length()))
+    pollute();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename SetAlloc>
+FrozenFlatSet<Value, Comparer, Alloc>::FrozenFlatSet(FlatSet<Value, Comparer, SetAlloc>&& set,
+  Comparer&& comparer, Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
+{
+  if (build(set._values.data(), set.length()))
+    set.purge();
+  else
+    pollute();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+Value const& FrozenFlatSet<Value, Comparer, Alloc>::operator [] (Location const& location) const noexcept
+{
+  return this->_keys[location.index()];
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+void FrozenFlatSet<Value, Comparer, Alloc>::clear() noexcept
+{
+  this->_keys.clear();
+  this->_order.clear();
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FrozenFlatSet<Value, Comparer, Alloc>& FrozenFlatSet<Value, Comparer, Alloc>::pollute() noexcept
+{
+  this->_keys.pollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+FrozenFlatSet<Value, Comparer, Alloc>& FrozenFlatSet<Value, Comparer, Alloc>::unpollute() noexcept
+{
+  this->_keys.unpollute();
+  this->_order.unpollute();
+  return *this;
+}
+
+template <typename Value, typename Comparer, typename Alloc>
+template <typename Source>
+bool FrozenFlatSet<Value, Comparer, Alloc>::build(Source* const values, Containers::Length const count)
+{
+  clear();
+
+  Array<Containers::Length, Alloc> positions(static_cast<Alloc&&>(Alloc(this->_keys.allocator())));
+
+  if (!this->arrange(positions, count) || !this->_keys.capacity(count))
+  {
+    clear();
+    return false; // Memory allocation failure
+  }
+
+  for (Containers::Length i = 0; i < count; ++i)
+    this->_keys.addp(static_cast<Source&&>(values[positions[i]]));
+
+  return true;
+}
+
+// BTree<Element, Key, Comparer, Alloc>::Iterator members.
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::Iterator::Iterator(Node* node, int32_t index) noexcept
+{
+  // Past the last element of a node, the next element is the one that follows this node in its parent.
+  while (node && index >= node->length)
+  {
+    index = node->position;
+    node = node->parent;
+  }
+  _node = node;
+  _index = node ? index : 0;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Element const& BTree<Element, Key, Comparer, Alloc>::Iterator::operator * () const noexcept
+{
+  return element(_node, _index);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Element const* BTree<Element, Key, Comparer, Alloc>::Iterator::operator -> () const noexcept
+{
+  return &element(_node, _index);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator& BTree<Element, Key, Comparer,
+  Alloc>::Iterator::operator ++ () noexcept
+{
+  if (!_node->leaf)
+  {
+    // Next element is the first one in the subtree that follows the current element.
+    Node* node = child(_node, _index + 1);
+
+    while (!node->leaf)
+      node = child(node, 0);
+
+    _node = node;
+    _index = 0;
+  }
+  else
+    *this = Iterator(_node, _index + 1);
+
+  return *this;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::Iterator::operator == (Iterator const& iterator) const noexcept
+{
+  return _node == iterator._node && _index == iterator._index;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::Iterator::operator != (Iterator const& iterator) const noexcept
+{
+  return _node != iterator._node || _index != iterator._index;
+}
+
+// BTree<Element, Key, Comparer, Alloc> members.
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::BTree(Comparer&& comparer, Alloc&& alloc) noexcept
+: _root(nullptr),
+  _length(0u),
+  _comparer(static_cast<Comparer&&>(comparer)),
+  _alloc(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::BTree(BTree const& tree)
+: BTree(static_cast<Comparer&&>(Comparer(tree._comparer)), static_cast<Alloc&&>(Alloc(tree._alloc)))
+{
+  assert(this != &tree);
+
+  if (tree._root)
+  {
+    if ((_root = copyNode(tree._root, nullptr)) != nullptr)
+      _length = static_cast<Size>(tree.length());
+    else
+      polluted(true);
+  }
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::BTree(BTree&& tree) noexcept
+: _root(tree._root),
+  _length(tree._length),
+  _comparer(static_cast<Comparer&&>(tree._comparer)),
+  _alloc(static_cast<Alloc&&>(tree._alloc))
+{
+  assert(this != &tree);
+
+  tree._root = nullptr;
+  tree._length = 0u;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::~BTree()
+{
+  if (_root)
+    releaseNode(_root);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>& BTree<Element, Key, Comparer, Alloc>::operator = (BTree const& tree)
+{
+  assert(this != &tree);
+
+  if (_root)
+    releaseNode(_root);
+
+  _root = nullptr;
+  _length = 0u;
+  _comparer = tree._comparer;
+  _alloc = tree._alloc;
+
+  if (tree._root)
+  {
+    if ((_root = copyNode(tree._root, nullptr)) != nullptr)
+      _length = static_cast<Size>(tree.length());
+    else
+      polluted(true);
+  }
+  return *this;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>& BTree<Element, Key, Comparer, Alloc>::operator = (BTree&& tree) noexcept
+{
+  assert(this != &tree);
+
+  if (_root)
+    releaseNode(_root);
+
+  _root = tree._root;
+  _length = tree._length;
+  _comparer = static_cast<Comparer&&>(tree._comparer);
+  _alloc = static_cast<Alloc&&>(tree._alloc);
+
+  tree._root = nullptr;
+  tree._length = 0u;
+  return *this;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::begin() const noexcept
+{
+  Node* node = _root;
+
+  if (node)
+    while (!node->leaf)
+      node = child(node, 0);
+
+  return Iterator(node, 0);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::end() const noexcept
+{
+  return Iterator(nullptr, 0);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Element const& BTree<Element, Key, Comparer, Alloc>::first() const noexcept
+{
+  return *begin();
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Element const& BTree<Element, Key, Comparer, Alloc>::last() const noexcept
+{
+  Node* node = _root;
+
+  while (!node->leaf)
+    node = child(node, node->length);
+
+  return element(node, node->length - 1);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+BTree<Element, Key, Comparer, Alloc>::operator bool () const noexcept
+{
+  return !(_length & PolluteBit);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Length BTree<Element, Key, Comparer,
+  Alloc>::length() const noexcept
+{
+  return static_cast<Length>(_length & LengthMask);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::empty() const noexcept
+{
+  return !_root;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::clear() noexcept
+{
+  if (_root)
+  {
+    releaseNode(_root);
+    _root = nullptr;
+    _length &= PolluteBit;
+  }
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::exists(Key const& key) const noexcept
+{
+  Node* node;
+  int32_t index;
+  return search(node, index, key);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::find(Key const& key) const noexcept
+{
+  Node* node;
+  int32_t index;
+  return search(node, index, key) ? Iterator(node, index) : end();
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::lowerBound(Key const& key) const noexcept
+{
+  return bound(key, false);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::upperBound(Key const& key) const noexcept
+{
+  return bound(key, true);
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::erase(Key const& key) noexcept
+{
+  Node* node;
+  int32_t index;
+
+  if (search(node, index, key))
+  {
+    eraseAt(node, index);
+    return true;
+  }
+  else
+    return false; // Key does not exist.
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::erase(Iterator const& iterator) noexcept
+{
+  if (iterator._node)
+  {
+    eraseAt(iterator._node, iterator._index);
+    return true;
+  }
+  else
+    return false;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Length BTree<Element, Key, Comparer,
+  Alloc>::erase(Key const& from, Key const& to) noexcept
+{
+  Length count = 0;
+
+  for (Iterator iterator = lowerBound(from); iterator._node &&
+    _comparer(elementKey(*iterator), to) < 0; ++count)
+  {
+    // Unless the tree has been rebalanced, the next element has taken place of the erased one.
+    if (eraseAt(iterator._node, iterator._index))
+      iterator = lowerBound(from);
+    else
+      iterator = Iterator(iterator._node, iterator._index);
+  }
+  return count;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::search(Node*& node, int32_t& index, Key const& key) const noexcept
+{
+  node = nullptr;
+  index = 0;
+
+  for (Node* current = _root; current; current = current->leaf ? nullptr : child(current, index))
+  {
+    int32_t left = 0, right = current->length - 1;
+
+    while (left <= right)
+    {
+      int32_t const pivot = (left + right) / 2;
+      auto const res = _comparer(elementKey(element(current, pivot)), key);
+
+      if (res < 0)
+        left = pivot + 1;
+      else if (res > 0)
+        right = pivot - 1;
+      else
+      {
+        node = current;
+        index = pivot;
+        return true; // Key found.
+      }
+    }
+    node = current;
+    index = left;
+  }
+  return false; // Key not found, so the search has ended in a leaf.
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Element& BTree<Element, Key, Comparer, Alloc>::element(Node* const node, int32_t const index) noexcept
+{
+  return reinterpret_cast<Element*>(node->elements)[index];
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::insert(Node* node, int32_t index, Element&& element)
+{
+  // Nodes that are full on the way up from the leaf are split, so their siblings and possibly a new root are
+  // allocated in advance, keeping the container unchanged in case of a memory allocation failure.
+  Node* fullNodes[MaxHeight];
+  Node* siblings[MaxHeight];
+  Node* root = node ? nullptr : allocate(true);
+  int32_t splits = 0;
+
+  for (Node* full = node; full && full->length == NodeCapacity; full = full->parent, ++splits)
+  {
+    fullNodes[splits] = full;
+    siblings[splits] = allocate(full->leaf);
+
+    if (siblings[splits] && !full->parent)
+      root = allocate(false);
+
+    if (!siblings[splits] || (!full->parent && !root))
+    {
+      if (siblings[splits])
+        release(siblings[splits]);
+
+      while (splits--)
+        release(siblings[splits]);
+
+      return false; // Memory allocation failure.
+    }
+  }
+
+  if (!node)
+  {
+    if (!root)
+      return false; // Memory allocation failure.
+
+    _root = node = root;
+  }
+
+  // Nodes are split from the top, so that there is always room for the middle element in the parent.
+  for (int32_t i = splits - 1; i >= 0; --i)
+    split(fullNodes[i], siblings[i], i == splits - 1 ? root : nullptr);
+
+  if (splits && index > NodeCapacity / 2)
+  {
+    index -= NodeCapacity / 2 + 1;
+    node = siblings[0];
+  }
+
+  relocate(&BTree::element(node, index + 1), &BTree::element(node, index), node->length - index);
+  new (&BTree::element(node, index)) Element(static_cast<Element&&>(element));
+  ++node->length;
+  ++_length;
+  return true;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::polluted(bool const polluted) noexcept
+{
+  if (polluted)
+    _length |= PolluteBit;
+  else
+    _length &= ~PolluteBit;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+template <typename PairValue>
+Key const& BTree<Element, Key, Comparer, Alloc>::elementKey(Pair<Key, PairValue> const& pair) noexcept
+{
+  return pair.key;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+Key const& BTree<Element, Key, Comparer, Alloc>::elementKey(Key const& key) noexcept
+{
+  return key;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Node*& BTree<Element, Key, Comparer,
+  Alloc>::child(Node* const node, int32_t const index) noexcept
+{
+  return static_cast<InternalNode*>(node)->children[index];
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+int32_t BTree<Element, Key, Comparer, Alloc>::bound(Node const* const node, Key const& key,
+  bool const upper) const noexcept
+{
+  int32_t left = 0, right = node->length;
+
+  while (left < right)
+  {
+    int32_t const pivot = (left + right) / 2;
+    auto const res = _comparer(elementKey(element(const_cast<Node*>(node), pivot)), key);
+
+    if (res < 0 || (upper && res == 0))
+      left = pivot + 1;
+    else
+      right = pivot;
+  }
+  return left;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Iterator BTree<Element, Key, Comparer,
+  Alloc>::bound(Key const& key, bool const upper) const noexcept
+{
+  Iterator res = end();
+
+  for (Node* node = _root; node; )
+  {
+    int32_t const index = bound(node, key, upper);
+
+    // Element found in the node is the result, unless there is a closer one in the subtree before it.
+    if (index < node->length)
+      res = Iterator(node, index);
+
+    node = node->leaf ? nullptr : child(node, index);
+  }
+  return res;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Node* BTree<Element, Key, Comparer,
+  Alloc>::allocate(bool const leaf) noexcept
+{
+  void* const memory = _alloc.alloc(leaf ? sizeof(Node) : sizeof(InternalNode), alignof(InternalNode));
+  if (!memory)
+    return nullptr;
+
+  Node* const node = leaf ? new (memory) Node : new (memory) InternalNode;
+  node->parent = nullptr;
+  node->position = 0;
+  node->length = 0;
+  node->leaf = leaf;
+  return node;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::release(Node* const node) noexcept
+{
+  _alloc.free(node, node->leaf ? sizeof(Node) : sizeof(InternalNode), alignof(InternalNode));
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::relocate(Element* const dest, Element* const source,
+  int32_t const count) noexcept
+{
+  if constexpr (utility::TriviallyRelocatable<Element>::value)
+  {
+    if (count > 0)
+      memmove(static_cast<void*>(dest), static_cast<void const*>(source),
+        static_cast<size_t>(count) * sizeof(Element));
+  }
+  else if (dest < source)
+  {
+    for (int32_t i = 0; i < count; ++i)
+    {
+      new (dest + i) Element(static_cast<Element&&>(source[i]));
+      source[i].~Element();
+    }
+  }
+  else
+  {
+    for (int32_t i = count; i-- > 0; )
+    {
+      new (dest + i) Element(static_cast<Element&&>(source[i]));
+      source[i].~Element();
+    }
+  }
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::moveChildren(Node* const dest, int32_t const destIndex,
+  Node* const source, int32_t const sourceIndex, int32_t const count) noexcept
+{
+  if (count > 0)
+  {
+    memmove(&child(dest, destIndex), &child(source, sourceIndex), static_cast<size_t>(count) * sizeof(Node*));
+
+    for (int32_t i = destIndex; i < destIndex + count; ++i)
+    {
+      Node* const node = child(dest, i);
+      node->parent = dest;
+      node->position = i;
+    }
+  }
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::split(Node* const node, Node* const sibling, Node* const root) noexcept
+{
+  int32_t constexpr const middle = NodeCapacity / 2;
+
+  if (root)
+  {
+    child(root, 0) = node;
+    node->parent = root;
+    node->position = 0;
+    _root = root;
+  }
+
+  // Make room in the parent for the middle element and the sibling that follows the node.
+  Node* const parent = node->parent;
+  int32_t const position = node->position;
+
+  relocate(&element(parent, position + 1), &element(parent, position), parent->length - position);
+  moveChildren(parent, position + 2, parent, position + 1, parent->length - position);
+
+  new (&element(parent, position)) Element(static_cast<Element&&>(element(node, middle)));
+  element(node, middle).~Element();
+  child(parent, position + 1) = sibling;
+  sibling->parent = parent;
+  sibling->position = position + 1;
+  ++parent->length;
+
+  // Elements after the middle one are moved to the sibling.
+  relocate(&element(sibling, 0), &element(node, middle + 1), NodeCapacity - middle - 1);
+
+  if (!node->leaf)
+    moveChildren(sibling, 0, node, middle + 1, NodeCapacity - middle);
+
+  sibling->length = NodeCapacity - middle - 1;
+  node->length = middle;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+bool BTree<Element, Key, Comparer, Alloc>::eraseAt(Node* node, int32_t index) noexcept
+{
+  bool moved = false;
+
+  if (!node->leaf)
+  {
+    // Element of an internal node is replaced by the preceding element, which is always in a leaf.
+    Node* leaf = child(node, index);
+
+    while (!leaf->leaf)
+      leaf = child(leaf, leaf->length);
+
+    element(node, index) = static_cast<Element&&>(element(leaf, leaf->length - 1));
+    node = leaf;
+    index = leaf->length - 1;
+    moved = true;
+  }
+
+  element(node, index).~Element();
+  relocate(&element(node, index), &element(node, index + 1), node->length - index - 1);
+  --node->length;
+  --_length;
+
+  if (node != _root && node->length < NodeMinLength)
+  {
+    rebalance(node);
+    moved = true;
+  }
+
+  // Root without elements is replaced by its only child, or released if the container becomes empty.
+  if (!_root->length)
+  {
+    Node* const root = _root;
+
+    if (root->leaf)
+      _root = nullptr;
+    else
+    {
+      _root = child(root, 0);
+      _root->parent = nullptr;
+      _root->position = 0;
+    }
+    release(root);
+    moved = true;
+  }
+  return moved;
+}
+
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::rebalance(Node* node) noexcept
+{
+  while (node != _root && node->length < NodeMinLength)
+  {
+    Node* const parent = node->parent;
+    int32_t const position = node->position;
+    Node* const left = position > 0 ? child(parent, position - 1) : nullptr;
+    Node* const right = position < parent->length ? child(parent, position + 1) : nullptr;
 
-    for (Length i = 0; i < length; ++i)
+    if (left && left->length > NodeMinLength)
     {
-      new (data + i) Element(static_cast<Element&&>(_data[i]));
-      _data[i].~Element();
+      // Separating element moves down to the node, while the last element of the left sibling replaces it.
+      relocate(&element(node, 1), &element(node, 0), node->length);
+      new (&element(node, 0)) Element(static_cast<Element&&>(element(parent, position - 1)));
+      element(parent, position - 1).~Element();
+      new (&element(parent, position - 1)) Element(static_cast<Element&&>(element(left, left->length - 1)));
+      element(left, left->length - 1).~Element();
+
+      if (!node->leaf)
+      {
+        moveChildren(node, 1, node, 0, node->length + 1);
+        moveChildren(node, 0, left, left->length, 1);
+      }
+      --left->length;
+      ++node->length;
+      break;
     }
-    free(_data, capacityPrev);
-    _data = data;
-    _capacity = static_cast<Size>(capacity) | polluteBit;
-    return true;
+
+    if (right && right->length > NodeMinLength)
+    {
+      // Separating element moves down to the node, while the first element of the right sibling replaces it.
+      new (&element(node, node->length)) Element(static_cast<Element&&>(element(parent, position)));
+      element(parent, position).~Element();
+      new (&element(parent, position)) Element(static_cast<Element&&>(element(right, 0)));
+      element(right, 0).~Element();
+      relocate(&element(right, 0), &element(right, 1), right->length - 1);
+
+      if (!node->leaf)
+      {
+        moveChildren(node, node->length + 1, right, 0, 1);
+        moveChildren(right, 0, right, 1, right->length);
+      }
+      --right->length;
+      ++node->length;
+      break;
+    }
+
+    // Neither sibling has elements to spare, so the node is merged with one of them.
+    merge(parent, left ? position - 1 : position);
+    node = parent;
   }
-  else
-    return false; // Memory allocation failure
 }
 
-template <typename Element, typename Alloc>
-void Array<Element, Alloc>::deallocate()
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::merge(Node* const parent, int32_t const index) noexcept
 {
-  for (Length i = length(); i--; )
-    _data[i].~Element();
+  Node* const left = child(parent, index);
+  Node* const right = child(parent, index + 1);
 
-  free(_data, capacity());
+  new (&element(left, left->length)) Element(static_cast<Element&&>(element(parent, index)));
+  element(parent, index).~Element();
+  relocate(&element(left, left->length + 1), &element(right, 0), right->length);
+
+  if (!left->leaf)
+    moveChildren(left, left->length + 1, right, 0, right->length + 1);
+
+  left->length += right->length + 1;
+
+  relocate(&element(parent, index), &element(parent, index + 1), parent->length - index - 1);
+  moveChildren(parent, index + 1, parent, index + 2, parent->length - index - 1);
+  --parent->length;
+
+  right->length = 0;
+  release(right);
 }
 
-template <typename Element, typename Alloc>
-Element* Array<Element, Alloc>::alloc(Length const count)
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+typename BTree<Element, Key, Comparer, Alloc>::Node* BTree<Element, Key, Comparer,
+  Alloc>::copyNode(Node const* const node, Node* const parent)
 {
-  return static_cast<Element*>(_alloc.alloc(static_cast<size_t>(count) * sizeof(Element), alignof(Element)));
+  Node* const copy = allocate(node->leaf);
+  if (!copy)
+    return nullptr;
+
+  copy->parent = parent;
+  copy->position = node->position;
+
+  for (int32_t i = 0; i < node->length; ++i)
+    new (&element(copy, i)) Element(element(const_cast<Node*>(node), i));
+
+  copy->length = node->length;
+
+  if (!node->leaf)
+    for (int32_t i = 0; i <= node->length; ++i)
+    {
+      Node* const childCopy = copyNode(child(const_cast<Node*>(node), i), copy);
+
+      if (!childCopy)
+      {
+        // Children that have been copied so far are released together with the node.
+        while (i--)
+          releaseNode(child(copy, i));
+
+        for (int32_t j = 0; j < copy->length; ++j)
+          element(copy, j).~Element();
+
+        release(copy);
+        return nullptr;
+      }
+      child(copy, i) = childCopy;
+    }
+
+  return copy;
 }
 
-template <typename Element, typename Alloc>
-void Array<Element, Alloc>::free(Element* const data, Length const count)
+template <typename Element, typename Key, typename Comparer, typename Alloc>
+void BTree<Element, Key, Comparer, Alloc>::releaseNode(Node* const node) noexcept
 {
-  _alloc.free(data, static_cast<size_t>(count) * sizeof(Element), alignof(Element));
+  if (!node->leaf)
+    for (int32_t i = 0; i <= node->length; ++i)
+      releaseNode(child(node, i));
+
+  for (int32_t i = 0; i < node->length; ++i)
+    element(node, i).~Element();
+
+  release(node);
 }
 
-// FlatMap<Key, Value, Comparer> members.
+// Map<Key, Value, Comparer, Alloc> members.
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>::FlatMap(Comparer&& comparer, Alloc&& alloc) noexcept
-: _pairs(static_cast<Alloc&&>(alloc)),
-  _comparer(static_cast<Comparer&&>(comparer))
+Map<Key, Value, Comparer, Alloc>::Map(Comparer&& comparer, Alloc&& alloc) noexcept
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
 {
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>::FlatMap(std::initializer_list<KeyValue> const pairs,
-  Comparer&& comparer, Alloc&& alloc) noexcept
-: _pairs(static_cast<Alloc&&>(alloc)),
-  _comparer(static_cast<Comparer&&>(comparer))
+Map<Key, Value, Comparer, Alloc>::Map(std::initializer_list<KeyValue> const pairs, Comparer&& comparer,
+  Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
 {
-  if (capacity(static_cast<Length>(pairs.size())))
-  {
-    for (KeyValue const* pair = pairs.begin(); pair != pairs.end(); ++pair)
-      if (!add(pair->key, pair->value))
-      {
-        pollute();
-        break;
-      }
-  }
-  else
-    pollute();
+  for (KeyValue const* pair = pairs.begin(); pair != pairs.end(); ++pair)
+    addp(pair->key, pair->value);
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::KeyValue const& FlatMap<Key, Value, Comparer,
-  Alloc>::operator [] (Location const& location) const noexcept
+bool Map<Key, Value, Comparer, Alloc>::add(Key const& key, Value const& value)
 {
-  return _pairs[location.index()];
+  return elementAdd(key, value);
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::KeyValue const* FlatMap<Key, Value, Comparer,
-  Alloc>::begin() const noexcept
+bool Map<Key, Value, Comparer, Alloc>::add(Key const& key, Value&& value)
 {
-  return _pairs.begin();
+  return elementAdd(key, static_cast<Value&&>(value));
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::KeyValue const* FlatMap<Key, Value, Comparer,
-  Alloc>::end() const noexcept
+bool Map<Key, Value, Comparer, Alloc>::add(Key&& key, Value const& value)
 {
-  return _pairs.end();
+  return elementAdd(static_cast<Key&&>(key), value);
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::KeyValue const& FlatMap<Key, Value, Comparer,
-  Alloc>::first() const noexcept
+bool Map<Key, Value, Comparer, Alloc>::add(Key&& key, Value&& value)
 {
-  return _pairs.first();
+  return elementAdd(static_cast<Key&&>(key), static_cast<Value&&>(value));
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::KeyValue const& FlatMap<Key, Value, Comparer,
-  Alloc>::last() const noexcept
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::addp(Key const& key, Value const& value)
 {
-  return _pairs.last();
+  if (!add(key, value))
+    pollute();
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>::operator bool () const noexcept
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::addp(Key const& key, Value&& value)
 {
-  return static_cast<bool>(_pairs);
+  if (!add(key, static_cast<Value&&>(value)))
+    pollute();
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::Length FlatMap<Key, Value, Comparer,
-  Alloc>::capacity() const noexcept
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::addp(Key&& key, Value const& value)
 {
-  return _pairs.capacity();
+  if (!add(static_cast<Key&&>(key), value))
+    pollute();
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::capacity(Length const capacity)
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::addp(Key&& key, Value&& value)
 {
-  return _pairs.capacity(capacity);
+  if (!add(static_cast<Key&&>(key), static_cast<Value&&>(value)))
+    pollute();
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-typename FlatMap<Key, Value, Comparer, Alloc>::Length FlatMap<Key, Value, Comparer,
-  Alloc>::length() const noexcept
+Value const* Map<Key, Value, Comparer, Alloc>::value(Key const& key) const noexcept
 {
-  return _pairs.length();
+  typename Tree::Node* node;
+  int32_t index;
+  return this->search(node, index, key) ? &Tree::element(node, index).value : nullptr;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-void FlatMap<Key, Value, Comparer, Alloc>::clear() noexcept
+Value* Map<Key, Value, Comparer, Alloc>::value(Key const& key) noexcept
 {
-  _pairs.clear();
+  typename Tree::Node* node;
+  int32_t index;
+  return this->search(node, index, key) ? &Tree::element(node, index).value : nullptr;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::shrink() noexcept
+Value const& Map<Key, Value, Comparer, Alloc>::at(Iterator const& iterator) const noexcept
 {
-  return _pairs.shrink();
+  return iterator->value;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-void FlatMap<Key, Value, Comparer, Alloc>::purge() noexcept
+Value& Map<Key, Value, Comparer, Alloc>::at(Iterator const& iterator) noexcept
 {
-  _pairs.purge();
+  return const_cast<Value&>(iterator->value);
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::exists(Key const& key) const noexcept
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::pollute() noexcept
 {
-  Length index;
-  return search(index, key);
+  this->polluted(true);
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-Containers::Location FlatMap<Key, Value, Comparer, Alloc>::add(Key const& key, Value const& value)
+Map<Key, Value, Comparer, Alloc>& Map<Key, Value, Comparer, Alloc>::unpollute() noexcept
 {
-  Length index;
-  if (search(index, key))
-    _pairs[index].value = value;
-  else if (!_pairs.insert(index, static_cast<KeyValue&&>(KeyValue(key, value))))
-    index = NotFound;
-  return Location(index);
+  this->polluted(false);
+  return *this;
 }
 
 template <typename Key, typename Value, typename Comparer, typename Alloc>
-Containers::Location FlatMap<Key, Value, Comparer, Alloc>::add(Key const& key, Value&& value)
+template <typename KeyType, typename ValueType>
+bool Map<Key, Value, Comparer, Alloc>::elementAdd(KeyType&& key, ValueType&& value)
 {
-  Length index;
-  if (search(index, key))
-    _pairs[index].value = static_cast<Value&&>(value);
-  else if (!_pairs.insert(index, static_cast<KeyValue&&>(KeyValue(key, static_cast<Value&&>(value)))))
-    index = NotFound;
-  return Location(index);
+  typename Tree::Node* node;
+  int32_t index;
+
+  if (this->search(node, index, key))
+  {
+    Tree::element(node, index).value = static_cast<ValueType&&>(value);
+    return true;
+  }
+  else
+    return this->insert(node, index, KeyValue(static_cast<KeyType&&>(key), static_cast<ValueType&&>(value)));
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Containers::Location FlatMap<Key, Value, Comparer, Alloc>::add(Key&& key, Value const& value)
+// Set<Value, Comparer, Alloc> members.
+
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>::Set(Comparer&& comparer, Alloc&& alloc) noexcept
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
 {
-  Length index;
-  if (search(index, key))
-    _pairs[index].value = value;
-  else if (!_pairs.insert(index, static_cast<KeyValue&&>(KeyValue(static_cast<Key&&>(key), value))))
-    index = NotFound;
-  return Location(index);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Containers::Location FlatMap<Key, Value, Comparer, Alloc>::add(Key&& key, Value&& value)
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>::Set(std::initializer_list<Value> const values, Comparer&& comparer, Alloc&& alloc)
+: Tree(static_cast<Comparer&&>(comparer), static_cast<Alloc&&>(alloc))
 {
-  Length index;
-  if (search(index, key))
-    _pairs[index].value = static_cast<Value&&>(value);
-  else if (!_pairs.insert(index, static_cast<KeyValue&&>(KeyValue(static_cast<Key&&>(key),
-    static_cast<Value&&>(value)))))
-    index = NotFound;
-  return Location(index);
+  for (Value const* value = values.begin(); value != values.end(); ++value)
+    addp(*value);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::insert(Location const& location, Key const& key,
-  Value const& value)
+template <typename Value, typename Comparer, typename Alloc>
+bool Set<Value, Comparer, Alloc>::add(Value const& value)
 {
-  return _pairs.insert(location.index(), static_cast<KeyValue&&>(KeyValue(key, value)));
+  return elementAdd(value, false);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::insert(Location const& location, Key const& key, Value&& value)
+template <typename Value, typename Comparer, typename Alloc>
+bool Set<Value, Comparer, Alloc>::add(Value&& value)
 {
-  return _pairs.insert(location.index(),
-    static_cast<KeyValue&&>(KeyValue(key, static_cast<Value&&>(value))));
+  return elementAdd(static_cast<Value&&>(value), false);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::insert(Location const& location, Key&& key, Value const& value)
+template <typename Value, typename Comparer, typename Alloc>
+bool Set<Value, Comparer, Alloc>::update(Value const& value)
 {
-  return _pairs.insert(location.index(),
-    static_cast<KeyValue&&>(KeyValue(static_cast<Key&&>(key), value)));
+  return elementAdd(value, true);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::insert(Location const& location, Key&& key, Value&& value)
+template <typename Value, typename Comparer, typename Alloc>
+bool Set<Value, Comparer, Alloc>::update(Value&& value)
 {
-  return _pairs.insert(location.index(),
-    static_cast<KeyValue&&>(KeyValue(static_cast<Key&&>(key), static_cast<Value&&>(value))));
+  return elementAdd(static_cast<Value&&>(value), true);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::addp(Key const& key,
-  Value const& value)
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>& Set<Value, Comparer, Alloc>::addp(Value const& value)
 {
-  if (!add(key, value))
+  if (!add(value))
     pollute();
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::addp(Key const& key, Value&& value)
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>& Set<Value, Comparer, Alloc>::addp(Value&& value)
 {
-  if (!add(key, static_cast<Value&&>(value)))
+  if (!add(static_cast<Value&&>(value)))
     pollute();
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::addp(Key&& key, Value const& value)
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>& Set<Value, Comparer, Alloc>::pollute() noexcept
 {
-  if (!add(static_cast<Key&&>(key), value))
-    pollute();
+  this->polluted(true);
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::addp(Key&& key, Value&& value)
+template <typename Value, typename Comparer, typename Alloc>
+Set<Value, Comparer, Alloc>& Set<Value, Comparer, Alloc>::unpollute() noexcept
 {
-  if (!add(static_cast<Key&&>(key), static_cast<Value&&>(value)))
-    pollute();
+  this->polluted(false);
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::erase(Key const& key) noexcept
+template <typename Value, typename Comparer, typename Alloc>
+template <typename ValueType>
+bool Set<Value, Comparer, Alloc>::elementAdd(ValueType&& value, bool const update)
 {
-  Length index;
-  if (search(index, key))
-    return _pairs.erase(index);
+  typename Tree::Node* node;
+  int32_t index;
+
+  if (this->search(node, index, value))
+  {
+    if (update)
+      Tree::element(node, index) = static_cast<ValueType&&>(value);
+
+    return true;
+  }
   else
-    return false; // Key does not exist.
+    return this->insert(node, index, Value(static_cast<ValueType&&>(value)));
+}
+
+// HashMap<Key, Value, Hasher, Alloc> members.
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::Iterator::Iterator(HashMap const* const map, Length const index) noexcept
+: _map(map),
+  _index(index)
+{
+  Length const slots = map->slots();
+
+  while (_index < slots && map->_controls[_index] < 0)
+    ++_index;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::KeyValue const& HashMap<Key, Value, Hasher,
+  Alloc>::Iterator::operator * () const noexcept
+{
+  return _map->_slots[_index];
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::KeyValue const* HashMap<Key, Value, Hasher,
+  Alloc>::Iterator::operator -> () const noexcept
+{
+  return _map->_slots + _index;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Iterator& HashMap<Key, Value, Hasher,
+  Alloc>::Iterator::operator ++ () noexcept
+{
+  Length const slots = _map->slots();
+
+  while (++_index < slots && _map->_controls[_index] < 0);
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::Iterator::operator == (Iterator const& iterator) const noexcept
+{
+  return _index == iterator._index;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::Iterator::operator != (Iterator const& iterator) const noexcept
+{
+  return _index != iterator._index;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::HashMap(Hasher&& hasher, Alloc&& alloc) noexcept
+: _controls(nullptr),
+  _slots(nullptr),
+  _capacity(0u),
+  _length(0),
+  _growthLeft(0),
+  _hasher(static_cast<Hasher&&>(hasher)),
+  _alloc(static_cast<Alloc&&>(alloc))
+{
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::HashMap(std::initializer_list<KeyValue> const pairs, Hasher&& hasher,
+  Alloc&& alloc)
+: HashMap(static_cast<Hasher&&>(hasher), static_cast<Alloc&&>(alloc))
+{
+  if (capacity(static_cast<Length>(pairs.size())))
+  {
+    for (KeyValue const* pair = pairs.begin(); pair != pairs.end(); ++pair)
+      if (!add(pair->key, pair->value))
+      {
+        pollute();
+        break;
+      }
+  }
+  else
+    pollute();
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::HashMap(HashMap const& map)
+: HashMap(static_cast<Hasher&&>(Hasher(map._hasher)), static_cast<Alloc&&>(Alloc(map._alloc)))
+{
+  assert(this != &map);
+  copyFrom(map);
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::HashMap(HashMap&& map) noexcept
+: _controls(map._controls),
+  _slots(map._slots),
+  _capacity(map._capacity),
+  _length(map._length),
+  _growthLeft(map._growthLeft),
+  _hasher(static_cast<Hasher&&>(map._hasher)),
+  _alloc(static_cast<Alloc&&>(map._alloc))
+{
+  assert(this != &map);
+
+  map._controls = nullptr;
+  map._slots = nullptr;
+  map._capacity = 0u;
+  map._length = map._growthLeft = 0;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::~HashMap()
+{
+  deallocate();
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::operator = (HashMap const& map)
+{
+  assert(this != &map);
+
+  deallocate();
+  _controls = nullptr;
+  _slots = nullptr;
+  _capacity = 0u;
+  _length = _growthLeft = 0;
+  _hasher = map._hasher;
+  _alloc = map._alloc;
+
+  copyFrom(map);
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::operator = (HashMap&& map) noexcept
+{
+  assert(this != &map);
+
+  deallocate();
+  _controls = map._controls;
+  _slots = map._slots;
+  _capacity = map._capacity;
+  _length = map._length;
+  _growthLeft = map._growthLeft;
+  _hasher = static_cast<Hasher&&>(map._hasher);
+  _alloc = static_cast<Alloc&&>(map._alloc);
+
+  map._controls = nullptr;
+  map._slots = nullptr;
+  map._capacity = 0u;
+  map._length = map._growthLeft = 0;
+  return *this;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::KeyValue const& HashMap<Key, Value, Hasher,
+  Alloc>::operator [] (Location const& location) const noexcept
+{
+  return _slots[location.index()];
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Iterator HashMap<Key, Value, Hasher,
+  Alloc>::begin() const noexcept
+{
+  return Iterator(this, 0);
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Iterator HashMap<Key, Value, Hasher,
+  Alloc>::end() const noexcept
+{
+  return Iterator(this, slots());
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>::operator bool () const noexcept
+{
+  return !(_capacity & PolluteBit);
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::capacity() const noexcept
+{
+  return slotsCapacity(slots());
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::capacity(Length const capacity)
+{
+  if (capacity <= this->capacity())
+    return true;
+
+  if (capacity > MaxLength / 2)
+    return false; // Overflow
+
+  // Find the smallest power of two number of slots that keeps maximum load factor of 7/8.
+  Length const slots = static_cast<Length>(math::ceilPowerOfTwo(static_cast<size_t>(
+    math::max<Length>(capacity + capacity / 7, MinSlots))));
+
+  return slotsCapacity(slots) >= capacity ? rehash(slots) : rehash(slots * 2);
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::length() const noexcept
+{
+  return _length;
+}
+
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::clear() noexcept
+{
+  if (Length const slots = this->slots())
+  {
+    for (Length i = 0; i < slots && _length; ++i)
+      if (_controls[i] >= 0)
+      {
+        _slots[i].~KeyValue();
+        --_length;
+      }
+
+    memset(_controls, ControlEmpty, static_cast<size_t>(slots + GroupWidth));
+    _growthLeft = slotsCapacity(slots);
+  }
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::erase(Location const& location) noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::shrink() noexcept
 {
-  return location ? _pairs.erase(location.index()) : false;
+  if (!_length)
+  {
+    purge();
+    return true;
+  }
+  Length slots = static_cast<Length>(math::ceilPowerOfTwo(static_cast<size_t>(
+    math::max<Length>(_length + _length / 7, MinSlots))));
+
+  if (slotsCapacity(slots) < _length)
+    slots *= 2;
+
+  return slots < this->slots() ? rehash(slots) : true;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Value const* FlatMap<Key, Value, Comparer, Alloc>::value(Key const& key) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::purge() noexcept
 {
-  Length index;
-  return search(index, key) ? &_pairs[index].value : nullptr;
+  deallocate();
+  _controls = nullptr;
+  _slots = nullptr;
+  _capacity &= PolluteBit;
+  _length = _growthLeft = 0;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Value* FlatMap<Key, Value, Comparer, Alloc>::value(Key const& key) noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::exists(Key const& key) const noexcept
 {
-  Length index;
-  return search(index, key) ? &_pairs[index].value : nullptr;
+  return search(key, _hasher(key)) != NotFound;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Value const& FlatMap<Key, Value, Comparer, Alloc>::at(Location const& location) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::add(Key const& key, Value const& value)
 {
-  return _pairs[location.index()].value;
+  return elementAdd(key, value);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Value& FlatMap<Key, Value, Comparer, Alloc>::at(Location const& location) noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::add(Key const& key, Value&& value)
 {
-  return _pairs[location.index()].value;
+  return elementAdd(key, static_cast<Value&&>(value));
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-Containers::Location FlatMap<Key, Value, Comparer, Alloc>::find(Key const& key) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::add(Key&& key, Value const& value)
 {
-  Length index;
-  return search(index, key) ? Location(index) : Location(NotFound);
+  return elementAdd(static_cast<Key&&>(key), value);
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::find(Location& location, Key const& key) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::add(Key&& key, Value&& value)
 {
-  Length index;
-  bool const found = search(index, key);
-  location = Location(index);
-  return found;
+  return elementAdd(static_cast<Key&&>(key), static_cast<Value&&>(value));
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::empty() const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::addp(Key const& key,
+  Value const& value)
 {
-  return _pairs.empty();
+  if (!add(key, value))
+    pollute();
+  return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::pollute() noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::addp(Key const& key, Value&& value)
 {
-  _pairs.pollute();
+  if (!add(key, static_cast<Value&&>(value)))
+    pollute();
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-FlatMap<Key, Value, Comparer, Alloc>& FlatMap<Key, Value, Comparer, Alloc>::unpollute() noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::addp(Key&& key, Value const& value)
 {
-  _pairs.unpollute();
+  if (!add(static_cast<Key&&>(key), value))
+    pollute();
   return *this;
 }
 
-template <typename Key, typename Value, typename Comparer, typename Alloc>
-bool FlatMap<Key, Value, Comparer, Alloc>::search(Length& index, Key const& key) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::addp(Key&& key, Value&& value)
 {
-  Length left = 0, right = _pairs.length() - 1;
+  if (!add(static_cast<Key&&>(key), static_cast<Value&&>(value)))
+    pollute();
+  return *this;
+}
 
-  while (left <= right)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::erase(Key const& key) noexcept
+{
+  Length const index = search(key, _hasher(key));
+  if (index != NotFound)
   {
-    Length const pivot = (left + right) / 2;
-    auto const res = _comparer(_pairs[pivot].key, key);
-
-    if (res < 0)
-      left = pivot + 1;
-    else if (res > 0)
-      right = pivot - 1;
-    else
-    {
-      index = pivot;
-      return true; // Key found.
-    }
+    elementErase(index);
+    return true;
   }
-  index = left;
-  return false; // Key not found.
+  else
+    return false; // Key does not exist.
 }
 
-// FlatSet<Value, Comparer> members.
-
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>::FlatSet(Comparer&& comparer, Alloc&& alloc) noexcept
-: _values(static_cast<Alloc&&>(alloc)),
-  _comparer(static_cast<Comparer&&>(comparer))
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::erase(Location const& location) noexcept
 {
+  if (location && location.index() < slots() && _controls[location.index()] >= 0)
+  {
+    elementErase(location.index());
+    return true;
+  }
+  else
+    return false;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>::FlatSet(std::initializer_list<Value> const values, Comparer&& comparer,
-  Alloc&& alloc)
-: _values(static_cast<Alloc&&>(alloc)),
-  _comparer(static_cast<Comparer&&>(comparer))
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Value const* HashMap<Key, Value, Hasher, Alloc>::value(Key const& key) const noexcept
 {
-  static_cast<void>(capacity(static_cast<Length>(values.size())));
-
-  for (Value const* value = values.begin(); value != values.end(); ++value)
-    if (!add(*value))
-    {
-      pollute();
-      break;
-    }
+  Length const index = search(key, _hasher(key));
+  return index != NotFound ? &_slots[index].value : nullptr;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-Value const& FlatSet<Value, Comparer, Alloc>::operator [] (Location const& location) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Value* HashMap<Key, Value, Hasher, Alloc>::value(Key const& key) noexcept
 {
-  return _values[location.index()];
+  Length const index = search(key, _hasher(key));
+  return index != NotFound ? &_slots[index].value : nullptr;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-Value const* FlatSet<Value, Comparer, Alloc>::begin() const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Value const& HashMap<Key, Value, Hasher, Alloc>::at(Location const& location) const noexcept
 {
-  return _values.begin();
+  return _slots[location.index()].value;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-Value const* FlatSet<Value, Comparer, Alloc>::end() const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Value& HashMap<Key, Value, Hasher, Alloc>::at(Location const& location) noexcept
 {
-  return _values.end();
+  return _slots[location.index()].value;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>::operator bool () const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::find(Key const& key) const noexcept
 {
-  return static_cast<bool>(_values);
+  return Location(search(key, _hasher(key)));
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-typename FlatSet<Value, Comparer, Alloc>::Length FlatSet<Value, Comparer, Alloc>::capacity() const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::empty() const noexcept
 {
-  return _values.capacity();
+  return !_length;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::capacity(Length const capacity)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::pollute() noexcept
 {
-  return _values.capacity(capacity);
+  _capacity |= PolluteBit;
+  return *this;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-typename FlatSet<Value, Comparer, Alloc>::Length FlatSet<Value, Comparer, Alloc>::length() const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+HashMap<Key, Value, Hasher, Alloc>& HashMap<Key, Value, Hasher, Alloc>::unpollute() noexcept
 {
-  return _values.length();
+  _capacity &= ~PolluteBit;
+  return *this;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-void FlatSet<Value, Comparer, Alloc>::clear() noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::slots() const noexcept
 {
-  _values.clear();
+  return static_cast<Length>(_capacity & LengthMask);
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::shrink() noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::slotsCapacity(Length const slots) noexcept
 {
-  return _values.shrink();
+  return slots - slots / 8;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-void FlatSet<Value, Comparer, Alloc>::purge() noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+size_t HashMap<Key, Value, Hasher, Alloc>::blockSize(Length const slots, size_t& slotsOffset) noexcept
 {
-  _values.clear();
-  static_cast<void>(_values.shrink());
-}
+  size_t const controlBytes = static_cast<size_t>(slots + GroupWidth);
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::exists(Value const& value) const noexcept
-{
-  Length index;
-  return search(index, value);
+  slotsOffset = (controlBytes + alignof(KeyValue) - 1) & ~(alignof(KeyValue) - 1);
+  return slotsOffset + static_cast<size_t>(slots) * sizeof(KeyValue);
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::add(Value const& value)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::search(Key const& key, size_t const hash) const noexcept
 {
-  Length index;
-  if (!search(index, value) && !_values.insert(index, value))
-    index = NotFound;
-  return Location(index);
-}
+  if (!_length)
+    return NotFound;
 
-template <typename Value, typename Comparer, typename Alloc>
-typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::add(Value&& value)
-{
-  Length index;
-  if (!search(index, value) && !_values.insert(index, static_cast<Value&&>(value)))
-    index = NotFound;
-  return Location(index);
-}
+  size_t const mask = static_cast<size_t>(slots() - 1);
+  Control const hashBits = static_cast<Control>(hash & 0x7F);
+  size_t position = (hash >> 7) & mask;
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::update(Value const& value)
-{
-  Length index;
-  if (!search(index, value))
-    return _values.insert(index, value);
-  else
+  // Triangular probing over groups, which visits every group when number of slots is a power of two.
+  for (size_t step = GroupWidth; ; step += GroupWidth)
   {
-    _values[index] = value;
-    return true;
+    ControlGroup const group(_controls + position);
+
+    for (ControlMask match = group.match(hashBits); match; match.next())
+    {
+      Length const index = static_cast<Length>((position + match.lowest()) & mask);
+      if (_hasher(_slots[index].key, key))
+        return index;
+    }
+    if (group.matchEmpty())
+      return NotFound; // Key would have been placed in this group.
+
+    position = (position + step) & mask;
   }
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::update(Value&& value)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::searchFree(size_t const hash) const noexcept
 {
-  Length index;
-  if (!search(index, value))
-    return _values.insert(index, static_cast<Value&&>(value));
-  else
+  size_t const mask = static_cast<size_t>(slots() - 1);
+  size_t position = (hash >> 7) & mask;
+
+  for (size_t step = GroupWidth; ; step += GroupWidth)
   {
-    _values[index] = static_cast<Value&&>(value);
-    return true;
+    if (ControlMask const match = ControlGroup(_controls + position).matchEmptyOrDeleted())
+      return static_cast<Length>((position + match.lowest()) & mask);
+
+    position = (position + step) & mask;
   }
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::insert(Location const& location, Value const& value)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+typename HashMap<Key, Value, Hasher, Alloc>::Length HashMap<Key, Value, Hasher,
+  Alloc>::prepareInsert(size_t const hash)
 {
-  return _values.insert(location.index(), value);
-}
+  Length slots = this->slots();
+  Length index = slots ? searchFree(hash) : NotFound;
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::insert(Location const& location, Value&& value)
-{
-  return _values.insert(location.index(), static_cast<Value&&>(value));
-}
+  if (index == NotFound || (!_growthLeft && _controls[index] != ControlDeleted))
+  {
+    // Reclaim deleted slots if there are many of them, otherwise grow the table.
+    if (slots && _length <= slotsCapacity(slots) / 2)
+    {
+      if (!rehash(slots))
+        return NotFound;
+    }
+    else if (slots > MaxLength / 2 || !rehash(slots ? slots * 2 : MinSlots))
+      return NotFound;
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::addp(Value const& value)
-{
-  if (!add(value))
-    pollute();
-  return *this;
+    index = searchFree(hash);
+  }
+  _growthLeft -= _controls[index] == ControlEmpty;
+  setControl(index, static_cast<Control>(hash & 0x7F));
+  ++_length;
+  return index;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::addp(Value&& value)
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+template <typename KeyType, typename ValueType>
+Containers::Location HashMap<Key, Value, Hasher, Alloc>::elementAdd(KeyType&& key, ValueType&& value)
 {
-  if (!add(static_cast<Value&&>(value)))
-    pollute();
-  return *this;
+  size_t const hash = _hasher(key);
+  Length index = search(key, hash);
+
+  if (index != NotFound)
+    _slots[index].value = static_cast<ValueType&&>(value);
+  else if ((index = prepareInsert(hash)) != NotFound)
+    new (_slots + index) KeyValue(static_cast<KeyType&&>(key), static_cast<ValueType&&>(value));
+
+  return Location(index);
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::erase(Value const& value) noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::elementErase(Length const index) noexcept
 {
-  Length index;
-  if (search(index, value))
-    return _values.erase(index);
+  _slots[index].~KeyValue();
+  --_length;
+
+  // If there is no full group around the slot, then no probe sequence could have passed through it, so it
+  // can be marked as empty instead of deleted.
+  size_t const mask = static_cast<size_t>(slots() - 1);
+  ControlMask const emptyBefore = ControlGroup(_controls + ((index - GroupWidth) & mask)).matchEmpty();
+  ControlMask const emptyAfter = ControlGroup(_controls + index).matchEmpty();
+
+  if (emptyBefore && emptyAfter && emptyAfter.lowest() + emptyBefore.leadingZeros() < GroupWidth)
+  {
+    setControl(index, ControlEmpty);
+    ++_growthLeft;
+  }
   else
-    return false; // Value does not exist
+    setControl(index, ControlDeleted);
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::erase(Location const& location) noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::setControl(Length const index, Control const control) noexcept
 {
-  return _values.erase(location.index());
-}
+  _controls[index] = control;
 
-template <typename Value, typename Comparer, typename Alloc>
-typename FlatSet<Value, Comparer, Alloc>::Location FlatSet<Value, Comparer, Alloc>::find(
-  Value const& value) const noexcept
-{
-  Length index;
-  return search(index, value) ? index : NotFound;
+  if (index < GroupWidth)
+    _controls[slots() + index] = control;
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::find(Location& index, Value const& value) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+bool HashMap<Key, Value, Hasher, Alloc>::rehash(Length const slots)
 {
-  return search(index, value);
-}
+  assert(slots >= MinSlots && math::isPowerOfTwo(slots) && slotsCapacity(slots) >= _length);
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::empty() const noexcept
-{
-  return _values.empty();
-}
+  size_t slotsOffset;
+  size_t const numBytes = blockSize(slots, slotsOffset);
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::pollute() noexcept
-{
-  _values.pollute();
-  return *this;
-}
+  if (uint8_t* const data = static_cast<uint8_t*>(_alloc.alloc(numBytes, alignof(KeyValue))))
+  {
+    Control* const controlsPrev = _controls;
+    KeyValue* const slotsPrev = _slots;
+    Length const slotsCountPrev = this->slots();
+
+    _controls = reinterpret_cast<Control*>(data);
+    _slots = reinterpret_cast<KeyValue*>(data + slotsOffset);
+    _capacity = static_cast<Size>(slots) | (_capacity & PolluteBit);
+    _growthLeft = slotsCapacity(slots) - _length;
+    memset(_controls, ControlEmpty, static_cast<size_t>(slots + GroupWidth));
+
+    for (Length i = 0; i < slotsCountPrev; ++i)
+      if (controlsPrev[i] >= 0)
+      {
+        size_t const hash = _hasher(slotsPrev[i].key);
+        Length const index = searchFree(hash);
 
-template <typename Value, typename Comparer, typename Alloc>
-FlatSet<Value, Comparer, Alloc>& FlatSet<Value, Comparer, Alloc>::unpollute() noexcept
-{
-  _values.unpollute();
-  return *this;
+        setControl(index, static_cast<Control>(hash & 0x7F));
+        new (_slots + index) KeyValue(static_cast<KeyValue&&>(slotsPrev[i]));
+        slotsPrev[i].~KeyValue();
+      }
+
+    if (controlsPrev)
+      _alloc.free(controlsPrev, blockSize(slotsCountPrev, slotsOffset), alignof(KeyValue));
+
+    return true;
+  }
+  else
+    return false; // Memory allocation failure
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-template <typename CustomValue, typename CustomCompare>
-bool FlatSet<Value, Comparer, Alloc>::find(Location& location, CustomValue const& value,
-  CustomCompare const& compare) const
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::copyFrom(HashMap const& map)
 {
-  Length left = 0, right = _values.length() - 1;
-
-  while (left <= right)
+  if (map._length)
   {
-    Length const pivot = (left + right) / 2;
-    auto const res = compare(_values[pivot], value);
+    Length const slots = map.slots();
+    size_t slotsOffset;
 
-    if (res < 0)
-      left = pivot + 1;
-    else if (res > 0)
-      right = pivot - 1;
-    else
+    if (uint8_t* const data = static_cast<uint8_t*>(_alloc.alloc(blockSize(slots, slotsOffset),
+      alignof(KeyValue))))
     {
-      location = Location(pivot);
-      return true; // Key found
+      _controls = reinterpret_cast<Control*>(data);
+      _slots = reinterpret_cast<KeyValue*>(data + slotsOffset);
+      memcpy(_controls, map._controls, static_cast<size_t>(slots + GroupWidth));
+
+      for (Length i = 0; i < slots; ++i)
+        if (_controls[i] >= 0)
+          new (_slots + i) KeyValue(map._slots[i]);
+
+      _capacity = static_cast<Size>(slots);
+      _length = map._length;
+      _growthLeft = map._growthLeft;
     }
+    else
+      pollute();
   }
-  location = Location(left);
-  return false; // Key not found
 }
 
-template <typename Value, typename Comparer, typename Alloc>
-bool FlatSet<Value, Comparer, Alloc>::search(Length& index, Value const& value) const noexcept
+template <typename Key, typename Value, typename Hasher, typename Alloc>
+void HashMap<Key, Value, Hasher, Alloc>::deallocate() noexcept
 {
-  Length left = 0, right = _values.length() - 1;
-
-  while (left <= right)
+  if (Length const slots = this->slots())
   {
-    Length const pivot = (left + right) / 2;
-    auto const res = _comparer(_values[pivot], value);
+    for (Length i = 0; i < slots; ++i)
+      if (_controls[i] >= 0)
+        _slots[i].~KeyValue();
 
-    if (res < 0)
-      left = pivot + 1;
-    else if (res > 0)
-      right = pivot - 1;
-    else
-    {
-      index = pivot;
-      return true; // Key found
-    }
+    size_t slotsOffset;
+    _alloc.free(_controls, blockSize(slots, slotsOffset), alignof(KeyValue));
   }
-  index = left;
-  return false; // Key not found
 }
 
 } // namespace trl
\ No newline at end of file
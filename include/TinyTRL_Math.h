@@ -82,6 +82,14 @@ namespace math {
 /// Calculates an average of two unsigned values without overflow.
 extern size_t average(size_t value1, size_t value2) noexcept;
 
+/// Returns the number of consecutive zero bits starting from the least significant bit. The given value
+/// must not be zero.
+inline int32_t countTrailingZeros(uint64_t value) noexcept;
+
+/// Returns the number of consecutive zero bits starting from the most significant bit. The given value
+/// must not be zero.
+inline int32_t countLeadingZeros(uint64_t value) noexcept;
+
 // Function declaration.
 
 // Common mathematical functions.
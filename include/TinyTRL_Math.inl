@@ -191,5 +191,47 @@ ValueType constexpr computeNextCapacity(ValueType const capacity, ValueType cons
   return capacityNew;
 }
 
+// Bit scanning functions.
+
+inline int32_t countTrailingZeros(uint64_t const value) noexcept
+{
+  assert(value != 0);
+#if defined(__GNUC__) || defined(__GNUG__) || defined(__clang__)
+  return __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(__PLATFORM_X64)
+  unsigned long res;
+  _BitScanForward64(&res, value);
+  return static_cast<int32_t>(res);
+#elif defined(_MSC_VER)
+  unsigned long res;
+  if (_BitScanForward(&res, static_cast<uint32_t>(value)))
+    return static_cast<int32_t>(res);
+  _BitScanForward(&res, static_cast<uint32_t>(value >> 32));
+  return static_cast<int32_t>(res) + 32;
+#else
+  #error "Unsupported compiler."
+#endif
+}
+
+inline int32_t countLeadingZeros(uint64_t const value) noexcept
+{
+  assert(value != 0);
+#if defined(__GNUC__) || defined(__GNUG__) || defined(__clang__)
+  return __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(__PLATFORM_X64)
+  unsigned long res;
+  _BitScanReverse64(&res, value);
+  return 63 - static_cast<int32_t>(res);
+#elif defined(_MSC_VER)
+  unsigned long res;
+  if (_BitScanReverse(&res, static_cast<uint32_t>(value >> 32)))
+    return 31 - static_cast<int32_t>(res);
+  _BitScanReverse(&res, static_cast<uint32_t>(value));
+  return 63 - static_cast<int32_t>(res);
+#else
+  #error "Unsupported compiler."
+#endif
+}
+
 } // namespace math
 } // namespace trl
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// TinyTRL_Profiler.h
+#pragma once
+
+#include "TinyTRL_Timing.h"
+#include "TinyTRL_Streams.h"
+
+namespace trl {
+
+/// Timer that measures its own lifetime and records it as a profiler event of the current thread.
+/// Typical usage is to declare it at the beginning of a scope that needs to be measured, for example:
+/// \code
+///   ProfileScope scope("decodeFrame");
+/// \endcode
+/// The name must be a string with static storage duration (e.g. a string literal), as it is stored by
+/// pointer and referenced when the results are written.
+class ProfileScope
+{
+public:
+  /// Starts measuring a scope with the given name.
+  explicit ProfileScope(char const* name) noexcept;
+
+  /// Stops measuring and records the event.
+  ~ProfileScope();
+
+  /// Copy (and move) constructor is not allowed.
+  ProfileScope(ProfileScope const&) = delete;
+
+  /// Copy (and move) assignment operator is not allowed.
+  ProfileScope& operator = (ProfileScope const&) = delete;
+
+private:
+  // Name of the scope.
+  char const* _name;
+
+  // Time in nanoseconds when the scope has started, or zero when profiler is disabled.
+  TickCount _start;
+};
+
+/// Default number of events that each thread can hold before the oldest ones are overwritten.
+static uint32_t constexpr const ProfilerDefaultCapacity = 16384;
+
+/// Enables or disables recording of profiler events. Profiler is enabled by default.
+extern void profilerEnable(bool enable);
+
+/// Tests whether recording of profiler events is enabled.
+extern bool profilerEnabled();
+
+/// Changes the number of events that each thread can hold before the oldest ones are overwritten. The value
+/// is rounded up to a power of two and applies only to threads that have not recorded any events yet.
+extern void profilerCapacity(uint32_t capacity);
+
+/// Records an event with the given name, starting time and duration in nanoseconds for the current thread.
+/// The name must be a string with static storage duration. This function is lock-free. Each thread gets its
+/// own event buffer on the first call; when a thread exits, its buffer (along with the recorded events) is
+/// handed over to the next new thread.
+extern void profilerRecord(char const* name, TickCount start, TickCount duration);
+
+/// Discards all events that have been recorded so far. This should not be called while other threads are
+/// recording events, otherwise some of those events may or may not be discarded.
+extern void profilerReset();
+
+/// Writes text report to the given stream, where for each distinct scope name its number of events and
+/// minimum, mean, median (p50), 99th percentile and maximum durations are listed in microseconds.
+/// Returns true on success and false in case of a memory allocation failure or write error.
+extern bool profilerWriteReport(Stream& stream);
+
+/// Writes all events in Chrome trace JSON format to the given stream, which can then be loaded in
+/// "chrome://tracing" or similar tools. Returns true on success and false in case of a memory allocation
+/// failure or write error.
+extern bool profilerWriteTrace(Stream& stream);
+
+} // namespace trl
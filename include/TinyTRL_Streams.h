@@ -202,6 +202,10 @@ public:
     /// File is going to be truncated if it already exists.
     ModeTruncate = 0x04,
 
+    /// Reads and writes go through an intermediary buffer of \c DefaultBufferSize bytes, so that small
+    /// operations do not result in a system call each.
+    ModeBuffered = 0x08,
+
     /// Prevent other processes reading from the file.
     ShareDenyRead = 0x10,
 
@@ -230,6 +234,9 @@ public:
   /// Generic file stream handle.
   typedef void* Handle;
 
+  /// Default size of intermediary buffer used by buffered file streams.
+  static Size constexpr const DefaultBufferSize = 65536;
+
   // Re-using read() function from stream class.
   using Stream::read;
 
@@ -275,9 +282,20 @@ public:
   /// Flushes file buffers and causes all previously buffered data to be written, if available.
   bool flush() override;
 
+  /// Returns current position relative to the beginning of the file, accounting for buffered data.
+  [[nodiscard]] Offset position() override;
+
   /// Returns the size of the file.
   [[nodiscard]] Offset size() override;
 
+  /// Returns size of intermediary buffer used for read-ahead and write-behind, or zero if the stream
+  /// is not buffered.
+  [[nodiscard]] Size bufferSize() const;
+
+  /// Changes size of intermediary buffer used for read-ahead and write-behind. Setting it to zero disables
+  /// buffering. Any pending data is written to the file before buffer is changed.
+  [[nodiscard]] bool bufferSize(Size size);
+
   /// Returns handle associated with the stream.
   Handle handle() const;
 
@@ -301,6 +319,37 @@ private:
   // Handle of the stream.
   Handle _handle;
 
+  // Intermediary buffer for read-ahead and write-behind operations.
+  uint8_t* _buffer;
+
+  // Allocated size of intermediary buffer.
+  Size _bufferCapacity;
+
+  // Number of bytes in the buffer that were either read ahead from the file or are pending to be written.
+  Size _bufferLength;
+
+  // Position of the next byte to be consumed from read-ahead data.
+  Size _bufferPosition;
+
+  // Whether the buffer contains data pending to be written (as opposed to read-ahead data).
+  bool _bufferWrite;
+
+  // Writes any pending data and discards read-ahead data, so that file position matches the logical
+  // position of the stream.
+  bool commitBuffer();
+
+  // Releases intermediary buffer without writing its contents.
+  void releaseBuffer();
+
+  // Reads data directly from the file handle.
+  Size readHandle(void* buffer, Size size);
+
+  // Writes data directly to the file handle.
+  Size writeHandle(void const* buffer, Size size);
+
+  // Adjusts position of the file handle.
+  Offset seekHandle(Offset offset, SeekOrigin origin);
+
   // Releases the handle value if such is valid and sets it to invalid state.
   void releaseHandle(Handle& handle) const;
 
@@ -359,12 +408,15 @@ public:
   using Stream::write;
 
   /// Creates a new instance of memory stream, optionally with a preallocated buffer of the given size.
-  MemoryStream(size_t capacity = 0);
+  /// The buffer is allocated from the given memory resource, which by default is the current one of the
+  /// thread (see ResourceScope), or with C heap functions if the resource is NULL.
+  MemoryStream(size_t capacity = 0, MemoryResource* resource = ResourceScope::current());
 
   /// Releases current instance of memory stream.
   ~MemoryStream() override;
 
-  /// Creates a new instance of memory stream being a copy of another instance.
+  /// Creates a new instance of memory stream being a copy of another instance, which uses the same memory
+  /// resource.
   MemoryStream(MemoryStream const& stream);
 
   /// Creates a new instance of memory stream and moves into it the contents of source class.
@@ -412,6 +464,9 @@ public:
   /// currently allocated capacity.
   void clear();
 
+  /// Returns memory resource of the buffer, or NULL if C heap functions are used.
+  [[nodiscard]] MemoryResource* resource() const;
+
 protected:
   /// Buffer that contains stream data.
   DataType* _buffer;
@@ -419,8 +474,75 @@ protected:
   /// Current allocated size of the buffer.
   size_t _capacity;
 
+  /// Memory resource of the buffer.
+  MemoryResource* _resource;
+
   // Reallocates buffer to the given capacity.
   bool reallocate(size_t capacity);
 };
 
+/// Read-only stream that maps contents of a file directly into memory, avoiding any intermediary copies.
+class MappedFileStream : public BaseMemoryStream
+{
+public:
+  using Stream::read;
+
+  /// Hints about expected access pattern of the mapped memory.
+  enum class Access : uint8_t
+  {
+    /// No particular access pattern, the default behavior.
+    Normal,
+
+    /// The memory is going to be accessed sequentially, so it can be aggressively read ahead.
+    Sequential,
+
+    /// The memory is going to be accessed in random order, so read ahead is not useful.
+    Random,
+
+    /// The whole memory is going to be needed soon, so it can be loaded in advance.
+    WillNeed
+  };
+
+  /// Creates a new instance of stream mapping the contents of the given file. In case of failure,
+  /// the stream is polluted.
+  MappedFileStream(String const& fileName);
+
+  /// Unmaps the file and releases current instance of the stream.
+  ~MappedFileStream() override;
+
+  /// Copy constructor is not allowed for mapped stream.
+  MappedFileStream(MappedFileStream const&) = delete;
+
+  /// Creates a new instance of stream taking the mapping from another instance.
+  MappedFileStream(MappedFileStream&& stream) noexcept;
+
+  /// Copy assignment is not allowed for mapped stream.
+  MappedFileStream& operator = (MappedFileStream const&) = delete;
+
+  /// Moves the mapping from another stream into the current one.
+  MappedFileStream& operator = (MappedFileStream&& stream) noexcept;
+
+  /// Reads a given number of bytes from the stream to buffer and returns the actual number of bytes read.
+  [[nodiscard]] Size read(void* buffer, Size size) override;
+
+  /// Returns a read-only direct pointer to mapped memory. For empty files, NULL is returned.
+  [[nodiscard]] DataType const* memory() const;
+
+  /// Provides a hint to the system about expected access pattern of mapped memory. Returns false if hint
+  /// could not be applied or is not supported on the current platform.
+  bool advise(Access access);
+
+  /// Returns contents of the mapped file as a string. If possible, the string wraps mapped memory without
+  /// copying, in which case it remains valid only while the stream is alive. Mapped file must not contain
+  /// null characters for the wrapped string to have a proper length.
+  [[nodiscard]] String string() const;
+
+private:
+  // Pointer to the beginning of mapped memory.
+  DataType* _memory;
+
+  // Unmaps the memory, if such is mapped.
+  void unmap();
+};
+
 } // namespace trl
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// TinyTRL_StringPool.h
+#pragma once
+
+#include "TinyTRL_Strings.h"
+
+namespace trl {
+
+struct AtomEntry;
+struct StringPoolTable;
+
+/// Handle of a string that has been interned by StringPool. Atoms of the same pool are equal only when
+/// their strings are equal, so they are compared by pointer, and their hash is computed only once.
+/// Atoms remain valid as long as their pool exists. An empty atom represents an empty string.
+class Atom
+{
+public:
+  /// Creates an empty atom.
+  Atom() noexcept;
+
+  /// Returns the interned string, which is wrapped without copying (see \c String::Wrap()).
+  [[nodiscard]] String string() const;
+
+  /// Returns pointer to the null-terminated characters of the interned string.
+  [[nodiscard]] char const* data() const noexcept;
+
+  /// Returns length of the interned string.
+  [[nodiscard]] String::Length length() const noexcept;
+
+  /// Returns hash of the interned string, same as \c utility::hash() would.
+  [[nodiscard]] size_t hash() const noexcept;
+
+  /// Tests whether the atom is empty.
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Tests whether two atoms of the same pool are equal.
+  bool operator == (Atom const& atom) const noexcept;
+
+  /// Tests whether two atoms of the same pool are different.
+  bool operator != (Atom const& atom) const noexcept;
+
+  /// Orders atoms by their address, which is consistent during the lifetime of the pool, but otherwise
+  /// arbitrary. This is suitable for using atoms as keys of FlatMap and FlatSet.
+  bool operator < (Atom const& atom) const noexcept;
+
+private:
+  friend class StringPool;
+
+  // Creates an atom with the given entry.
+  explicit Atom(AtomEntry const* entry) noexcept;
+
+  // Entry of the interned string, or NULL for an empty atom.
+  AtomEntry const* _entry;
+};
+
+/// Table of unique strings that have been interned, where each string is stored only once and is
+/// represented by Atom. Strings are stored in memory arenas and are never removed until the pool is
+/// destroyed. All functions can be called concurrently from multiple threads: looking up strings that
+/// have already been interned is lock-free, while adding new strings locks only one of several shards.
+class StringPool
+{
+public:
+  /// Number of shards, each of which holds strings of a subset of hashes.
+  static uint32_t constexpr const ShardCount = 16;
+
+  /// Creates an empty pool.
+  StringPool() noexcept;
+
+  /// Releases all strings. Any atoms of the pool must no longer be used.
+  ~StringPool();
+
+  /// Copy (and move) constructor is not allowed.
+  StringPool(StringPool const&) = delete;
+
+  /// Copy (and move) assignment operator is not allowed.
+  StringPool& operator = (StringPool const&) = delete;
+
+  /// Returns true when the pool is valid and false when it is polluted (has an error bit set).
+  [[nodiscard]] explicit operator bool () const;
+
+  /// Returns number of strings in the pool.
+  [[nodiscard]] String::Length length() const;
+
+  /// Returns atom of the given string, adding a copy of the string to the pool if it is not there yet.
+  /// In case of a memory allocation failure, returns an empty atom and pollutes the pool (sets an error bit).
+  [[nodiscard]] Atom intern(String const& string);
+
+  /// Returns atom of a string with a known length, adding a copy of the string to the pool if needed.
+  [[nodiscard]] Atom intern(char const* string, String::Length length);
+
+  /// Returns atom of the given string if it has been interned, or an empty atom otherwise.
+  [[nodiscard]] Atom find(String const& string) const;
+
+  /// Returns atom of a string with a known length if it has been interned, or an empty atom otherwise.
+  [[nodiscard]] Atom find(char const* string, String::Length length) const;
+
+private:
+  // Strings whose hashes have the same lowest bits.
+  struct Shard
+  {
+    // Hash table that is currently used, or NULL if no strings have been added yet.
+    StringPoolTable* table;
+
+    // Number of strings in the table.
+    uint32_t length;
+
+    // Non-zero while a string is being added.
+    uint32_t lock;
+
+    // Memory of the strings.
+    MonotonicArena<> arena;
+
+    Shard() noexcept;
+  };
+
+  // Finds entry of a string in the shard without locking, returning NULL if it is not found.
+  static AtomEntry const* search(Shard const& shard, char const* string, String::Length length, size_t hash);
+
+  // Adds string to the shard, unless another thread has already done so.
+  AtomEntry const* insert(Shard& shard, char const* string, String::Length length, size_t hash);
+
+  // Shards of the pool.
+  Shard _shards[ShardCount];
+
+  // Non-zero when a memory allocation has failed.
+  uint32_t _status;
+};
+
+namespace utility {
+
+// Service functors.
+
+/// Atom hasher, which can be used with HashMap. It uses precomputed hashes and compares atoms by pointer.
+struct AtomHasher
+{
+  /// Returns hash of the atom.
+  size_t operator () (Atom const& value) const;
+
+  /// Tests whether two atoms are equal.
+  bool operator () (Atom const& left, Atom const& right) const;
+};
+
+} // namespace utility
+} // namespace trl
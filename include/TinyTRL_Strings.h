@@ -14,13 +14,30 @@
 // TinyTRL_Strings.h
 #pragma once
 
-#include "TinyTRL_Math.h"
+#include "TinyTRL_Containers.h"
 
 namespace trl {
 
 // Forward declaration of WideString.
 class WideString;
 
+// Forward declaration of StringView.
+class StringView;
+
+/// Notation used for converting floating-point numbers to strings.
+enum class FloatFormat : uint8_t
+{
+  /// Fixed-point notation for numbers of moderate magnitude and scientific notation otherwise, same as
+  /// "%g" format of "printf".
+  General,
+
+  /// Fixed-point notation, same as "%f" format of "printf".
+  Fixed,
+
+  /// Scientific notation, same as "%e" format of "printf".
+  Scientific
+};
+
 /// String class that handles ASCII or UTF8-encoded strings with Short String Optimization that can store
 /// up to 23 characters on 64-bit platforms and up to 11 characters on 32-bit platforms. This implementation
 /// always appends null terminating character to the end of string, ensuring that \c String::data() always
@@ -334,6 +351,14 @@ public:
   /// polluted, the returned string is polluted as well.
   String substr(Length position = 0, Length length = NotFound) const;
 
+  /// Returns a view of the whole string without copying it. The view remains valid until the string is
+  /// modified or destroyed.
+  [[nodiscard]] StringView view() const;
+
+  /// Returns a view of a subset of current string without copying it, which has the same bounds as the
+  /// string returned by \c substr() would. The view remains valid until the string is modified or destroyed.
+  [[nodiscard]] StringView subview(Length position = 0, Length length = NotFound) const;
+
   /// Replaces a certain portion of current string with a portion from source string.
   String& replace(String const& source, Length position = 0, Length length = NotFound,
     Length sourcePosition = 0, Length sourceLength = NotFound);
@@ -460,6 +485,9 @@ private:
   // Returns the length of long string.
   Length longLength() const;
 
+  // Returns the capacity of long string, including null character.
+  Length longCapacity() const;
+
   // Returns the length of short string.
   Length shortLength() const;
 
@@ -486,6 +514,166 @@ private:
   static void secureErase(char* string, Length length);
 };
 
+/// Non-owning view of a string, which consists only of pointer to characters and their number. Unlike
+/// \c String::Wrap(), the characters do not need to be null-terminated and are never copied, so taking
+/// views of parts of a larger buffer (e.g. when splitting it into tokens) does not allocate memory.
+/// Characters must remain valid for as long as the view is used. Strings can be implicitly converted to
+/// views, so utility functions that only read strings accept both.
+class StringView
+{
+public:
+  using Length = String::Length;
+
+  /// Constant that indicates index not found.
+  static Length constexpr const NotFound = String::NotFound;
+
+  /// Creates an empty view.
+  StringView() noexcept;
+
+  /// Creates a view of an existing null-terminated string.
+  StringView(char const* string) noexcept;
+
+  /// Creates a view of the given number of characters, which do not need to be null-terminated.
+  StringView(char const* data, Length length) noexcept;
+
+  /// Creates a view of the whole string.
+  StringView(String const& string) noexcept;
+
+  /// Returns a constant pointer to the characters, which are not necessarily null-terminated.
+  [[nodiscard]] char const* data() const noexcept;
+
+  /// Provides addressing of view as if it was a constant array (without bounds checking).
+  [[nodiscard]] char const& operator [] (Length index) const noexcept;
+
+  /// Returns constant reference to first character in the view.
+  [[nodiscard]] char const& first() const noexcept;
+
+  /// Returns constant reference to last character in the view.
+  [[nodiscard]] char const& last() const noexcept;
+
+  /// Returns constant pointer to the first character in the view.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  char const* begin() const noexcept;
+
+  /// Returns constant pointer to one character past last in the view.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  char const* end() const noexcept;
+
+  /// Returns number of characters in the view.
+  [[nodiscard]] Length length() const noexcept;
+
+  /// Tests whether the view is empty.
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Returns a view of a subset of current view, which is clipped to its bounds in the same way as
+  /// \c String::substr() does.
+  [[nodiscard]] StringView subview(Length position = 0, Length length = NotFound) const noexcept;
+
+  /// Creates a new string instance copying the characters of the view.
+  /// Note: an unsuccessful memory allocation pollutes the string.
+  [[nodiscard]] String string() const;
+
+private:
+  // Pointer to the first character.
+  char const* _data;
+
+  // Number of characters.
+  Length _length;
+};
+
+/// Lazy range of fields of a string that are separated by a delimiter, which is either a single character,
+/// a sequence of characters or any character of a set. Fields are returned as views of the original string
+/// and are found one at a time during iteration, so splitting never allocates memory. Consecutive
+/// delimiters produce empty fields, same as a delimiter at the start or at the end of the string, while
+/// an empty string produces a single empty field. The string (and delimiters) must remain valid for as
+/// long as the range is used.
+class StringSplit
+{
+public:
+  using Length = String::Length;
+
+  /// Iterator over fields of the range.
+  class Iterator
+  {
+  public:
+    /// Returns view of the current field.
+    [[nodiscard]] StringView operator * () const noexcept;
+
+    /// Advances to the next field.
+    Iterator& operator ++ () noexcept;
+
+    /// Tests whether two iterators point to the same field.
+    bool operator == (Iterator const& iterator) const noexcept;
+
+    /// Tests whether two iterators point to different fields.
+    bool operator != (Iterator const& iterator) const noexcept;
+
+  private:
+    friend class StringSplit;
+
+    // Creates iterator pointing to a field that starts at the given position.
+    Iterator(StringSplit const* split, Length position) noexcept;
+
+    // Range that is being iterated.
+    StringSplit const* _split;
+
+    // Position of the first character of the field, or one past the string length at the end of range.
+    Length _position;
+
+    // Position of the delimiter that follows the field, or string length for the last field.
+    Length _end;
+  };
+
+  /// Creates range of fields separated by a single character.
+  StringSplit(StringView string, char delimiter) noexcept;
+
+  /// Creates range of fields separated by a sequence of characters. When the sequence is empty, the whole
+  /// string is returned as a single field.
+  StringSplit(StringView string, StringView delimiter) noexcept;
+
+  /// Creates range of fields separated by any single character of the given set.
+  [[nodiscard]] static StringSplit AnyOf(StringView string, StringView delimiters) noexcept;
+
+  /// Returns iterator pointing to the first field.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  Iterator begin() const noexcept;
+
+  /// Returns iterator pointing past the last field.
+  /// Note: this function is provided to enable C++11 ranged for and should not be used otherwise.
+  Iterator end() const noexcept;
+
+private:
+  // Kind of delimiter that separates fields.
+  enum class Mode : uint8_t
+  {
+    Char,
+    Sequence,
+    AnyOf
+  };
+
+  // Creates range with the given kind of delimiter.
+  StringSplit(StringView string, StringView delimiters, char delimiter, Mode mode) noexcept;
+
+  // Returns position of the first delimiter at or after the given position, or string length if there are
+  // no more delimiters.
+  Length search(Length position) const noexcept;
+
+  // Returns number of characters in a single delimiter.
+  Length delimiterLength() const noexcept;
+
+  // String that is being split.
+  StringView _string;
+
+  // Delimiter sequence or set of delimiter characters.
+  StringView _delimiters;
+
+  // Delimiter character in Mode::Char.
+  char _delimiter;
+
+  // Kind of delimiter.
+  Mode _mode;
+};
+
 /// UTF-16 string class implementation, commonly required on Windows for WinAPI calls. This implementation
 /// always appends null terminating character to the end of string, ensuring that \c WideString::data()
 /// always points to a null-terminated string.
@@ -674,6 +862,38 @@ private:
   static Length calculateLength(WideChar const* string, Length length = 0);
 };
 
+/// Immutable string paired with its case-sensitive hash, which is computed only once on construction.
+/// This is useful as a key of HashMap with \c utility::StringHasher, when the same keys are looked up
+/// repeatedly or when the table is rehashed, as long strings are then hashed only once.
+class HashedString
+{
+public:
+  /// Creates an empty hashed string.
+  HashedString();
+
+  /// Creates hashed string from a copy of the given string.
+  HashedString(String const& string);
+
+  /// Creates hashed string by moving the given string.
+  HashedString(String&& string);
+
+  /// Creates hashed string from a null-terminated string.
+  HashedString(char const* string);
+
+  /// Returns the string.
+  [[nodiscard]] String const& string() const;
+
+  /// Returns cached hash of the string, same as \c utility::hash() would.
+  [[nodiscard]] size_t hash() const;
+
+private:
+  // Contained string.
+  String _string;
+
+  // Hash of the contained string.
+  size_t _hash;
+};
+
 // String helper operators.
 
 /// Tests whether first string is lexicographically less than the second one.
@@ -694,8 +914,49 @@ extern bool operator == (String const& left, String const& right);
 /// Tests whether first string is lexicographically different to the second one.
 extern bool operator != (String const& left, String const& right);
 
+/// Tests whether first string view is lexicographically less than the second one.
+extern bool operator < (StringView left, StringView right);
+
+/// Tests whether first string view is lexicographically greater than the second one.
+extern bool operator > (StringView left, StringView right);
+
+/// Tests whether first string view is lexicographically less than or equal to the second one.
+extern bool operator <= (StringView left, StringView right);
+
+/// Tests whether first string view is lexicographically greater than or equal to the second one.
+extern bool operator >= (StringView left, StringView right);
+
+/// Tests whether first string view is lexicographically equal to the second one.
+extern bool operator == (StringView left, StringView right);
+
+/// Tests whether first string view is lexicographically different to the second one.
+extern bool operator != (StringView left, StringView right);
+
 namespace utility {
 
+// Type traits.
+
+/// Strings do not keep pointers to themselves, so they can be relocated by copying their bytes.
+template <>
+struct TriviallyRelocatable<String>
+{
+  static bool constexpr const value = true;
+};
+
+/// Wide strings do not keep pointers to themselves, so they can be relocated by copying their bytes.
+template <>
+struct TriviallyRelocatable<WideString>
+{
+  static bool constexpr const value = true;
+};
+
+/// Hashed strings can be relocated by copying their bytes, same as strings.
+template <>
+struct TriviallyRelocatable<HashedString>
+{
+  static bool constexpr const value = true;
+};
+
 // Character utilities.
 
 /// Converts the specified ANSI character code to upper case.
@@ -720,11 +981,11 @@ extern bool sameStr(char const* left, char const* right, String::Length length =
 
 /// Compares two strings lexicographically. If \c length parameter is specified, then up to that number of
 /// characters will be compared.
-extern String::Length compareStr(String const& left, String const& right, String::Length length = 0);
+extern String::Length compareStr(StringView left, StringView right, String::Length length = 0);
 
 /// Tests whether two strings are the same lexicographically. If \c length parameter is specified, then up
 /// to that number of characters will be compared.
-extern bool sameStr(String const& left, String const& right, String::Length length = 0);
+extern bool sameStr(StringView left, StringView right, String::Length length = 0);
 
 /// Compares two null-terminated text strings lexicographically without case-sensitivity (this only applies
 /// to ASCII characters). If \c length parameter is specified, then up to that number of characters will
@@ -737,13 +998,13 @@ extern bool sameText(char const* left, char const* right, String::Length length
 
 /// Compares two text strings lexicographically without case-sensitivity (this only applies to ASCII
 /// characters). If \c length parameter is specified, then up to that number of characters will be compared.
-extern String::Length compareText(String const& leftText, String const& rightText,
+extern String::Length compareText(StringView leftText, StringView rightText,
   String::Length length = 0);
 
 /// Tests whether two strings are the same lexicographically without case-sensitivity (this only applies
 /// to ASCII characters). If \c length parameter is specified, then up to that number of characters will
 /// be  compared.
-extern bool sameText(String const& leftText, String const& rightText, String::Length length = 0);
+extern bool sameText(StringView leftText, StringView rightText, String::Length length = 0);
 
 /// Compares two null-terminated text strings with a known length lexicographically without
 /// case-sensitivity (this only applies to ASCII characters). If \c length parameter is specified, then up
@@ -757,110 +1018,124 @@ extern String::Length compareText(char const* left, String::Length lengthLeft, c
 extern bool sameText(char const* left, String::Length lengthLeft, char const* right,
   String::Length lengthRight, String::Length length = 0);
 
+/// Computes hash of the given string. The result depends on the given seed and may differ between platforms,
+/// so it should not be stored persistently.
+extern size_t hash(StringView string, uint64_t seed = 0);
+
+/// Computes hash of a string with a known length.
+extern size_t hash(char const* string, String::Length length, uint64_t seed = 0);
+
+/// Computes hash of the given text string without case-sensitivity (this only applies to ASCII characters),
+/// so that texts that are the same according to \c sameText() have the same hash.
+extern size_t hashText(StringView text, uint64_t seed = 0);
+
+/// Computes hash of a text string with a known length without case-sensitivity.
+extern size_t hashText(char const* text, String::Length length, uint64_t seed = 0);
+
 /// Searches for a string match in a given string starting at the given position and length, if such are
 /// provided. Returns String::NotFound if match is not found.
-extern String::Length findStr(String const& string, String const& match, String::Length position = 0,
+extern String::Length findStr(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for a null-terminated string match in a given string starting at the given position and length,
 /// if such are provided. Returns String::NotFound if match is not found.
-extern String::Length findStr(String const& string, char const* match, String::Length position = 0,
+extern String::Length findStr(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for last match of a string in another string starting at the given position and length,
 /// if such is provided. Returns String::NotFound if match is not found.
-extern String::Length findStrLast(String const& string, String const& match, String::Length position = 0,
+extern String::Length findStrLast(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for last match of a null-terminated string in another string  starting at the given position
 /// and length, if such is provided. Returns String::NotFound if match is not found.
-extern String::Length findStrLast(String const& string, char const* match, String::Length position = 0,
+extern String::Length findStrLast(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for a string match in a given string without case-sensitivity (this only applies to ASCII
 /// characters) starting at the given position and length, if such are provided. Returns String::NotFound
 /// if match is not found.
-extern String::Length findText(String const& string, String const& match, String::Length position = 0,
+extern String::Length findText(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for a null-terminated string match in a given string without case-sensitivity (this only
 /// applies to ASCII characters) starting at the given position and length, if such are provided.
 /// Returns String::NotFound if match is not found.
-extern String::Length findText(String const& string, char const* match, String::Length position = 0,
+extern String::Length findText(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for last match of a string in another string without case-sensitivity (this only applies to
 /// ASCII characters) starting at the given position and length, if such is provided.
 /// Returns String::NotFound if match is not found.
-extern String::Length findTextLast(String const& string, String const& match, String::Length position = 0,
+extern String::Length findTextLast(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for last match of a null-terminated string in another string without case-sensitivity (this
 /// only applies to ASCII characters) starting at the given position and length, if such is provided.
 /// Returns String::NotFound if match is not found.
-extern String::Length findTextLast(String const& string, char const* match, String::Length position = 0,
+extern String::Length findTextLast(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for a character match in given string starting at the given position and length,
 /// if such are provided. Returns String::NotFound if match is not found.
-extern String::Length findChar(String const& string, char charCode, String::Length position = 0,
+extern String::Length findChar(StringView string, char charCode, String::Length position = 0,
   String::Length length = 0);
 
 /// Searches for last character match in current string starting at the given position and length,
 /// if such are provided. Returns String::NotFound if match is not found.
-extern String::Length findCharLast(String const& string, char charCode, String::Length position = 0,
+extern String::Length findCharLast(StringView string, char charCode, String::Length position = 0,
   String::Length length = 0);
 
 /// Tests whether a given string contains match of a source string starting at the given position and
 /// length, if such are provided.
-extern bool containsStr(String const& string, String const& match, String::Length position = 0,
+extern bool containsStr(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Tests whether a given string contains match of a null-terminated source string starting at the given
 /// position and length, if such are provided.
-extern bool containsStr(String const& string, char const* match, String::Length position = 0,
+extern bool containsStr(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Tests whether a given string contains match of a source string without case-sensitivity (this only
 /// applies to ASCII characters) starting at the given position and length, if such are provided.
-extern bool containsText(String const& string, String const& match, String::Length position = 0,
+extern bool containsText(StringView string, StringView match, String::Length position = 0,
   String::Length length = 0);
 
 /// Tests whether a given string contains match of a null-terminated source string without case-sensitivity
 /// (this only  applies to ASCII characters) starting at the given position and length, if such
 /// are provided.
-extern bool containsText(String const& string, char const* match, String::Length position = 0,
+extern bool containsText(StringView string, char const* match, String::Length position = 0,
   String::Length length = 0);
 
 /// Tests whether a given string has a match of a source string starting at the given position,
 /// if such is provided.
-extern bool startsWith(String const& string, String const& match, String::Length position = 0);
+extern bool startsWith(StringView string, StringView match, String::Length position = 0);
 
 /// Tests whether a given string has a match of a null-terminated source string starting at the given
 /// position, if such is provided.
-extern bool startsWith(String const& string, char const* match, String::Length position = 0);
+extern bool startsWith(StringView string, char const* match, String::Length position = 0);
 
 /// Tests whether a given string has a match of a source string without case-sensitivity (this only applies
 /// to ASCII characters) starting at the given position, if such is provided.
-extern bool startsWithText(String const& string, String const& match, String::Length position = 0);
+extern bool startsWithText(StringView string, StringView match, String::Length position = 0);
 
 /// Tests whether a given string has a match of a source null-terminated string without case-sensitivity
 /// (this only applies to ASCII characters) starting at the given position, if such is provided.
-extern bool startsWithText(String const& string, char const* match, String::Length position = 0);
+extern bool startsWithText(StringView string, char const* match, String::Length position = 0);
 
 /// Tests whether a given string ends with a given match of characters.
-extern bool endsWith(String const& string, String const& match);
+extern bool endsWith(StringView string, StringView match);
 
 /// Tests whether a given string ends with a given match of a null-terminated characters.
-extern bool endsWith(String const& string, char const* match);
+extern bool endsWith(StringView string, char const* match);
 
 /// Tests whether a given string ends with a given match of characters without case-sensitivity (this only
 /// applies to ASCII characters).
-extern bool endsWithText(String const& string, String const& match);
+extern bool endsWithText(StringView string, StringView match);
 
 /// Tests whether a given string ends with a given match of a null-terminated characters without
 /// case-sensitivity (this only applies to ASCII characters).
-extern bool endsWithText(String const& string, char const* match);
+extern bool endsWithText(StringView string, char const* match);
 
 /// Finds in a given string an instance of the specified character and replaces it with another character.
 /// If a memory allocation failure occurs (when trying to unwrap a wrapped string), then an error bit will
@@ -900,33 +1175,109 @@ extern String& searchReplaceTextAll(String& string, String const& match, String
 /// was passed as first parameter for chaining.
 extern String& searchEraseAll(String& string, String const& match);
 
-/// Parses a given string and converts it to 64-bit integer.
-extern bool strToInt(int64_t& dest, String const& string, int32_t base = 0);
+/// Returns lazy range of fields in a given string that are separated by the specified character.
+/// For example, splitting "a,,b" by "," produces "a", "" and "b" (see \c StringSplit for details).
+extern StringSplit split(StringView string, char delimiter);
+
+/// Returns lazy range of fields in a given string that are separated by the specified sequence of
+/// characters.
+extern StringSplit split(StringView string, StringView delimiter);
+
+/// Returns lazy range of fields in a given string that are separated by any single character of the
+/// specified set. For example, splitting "a b\tc" by " \t" produces "a", "b" and "c".
+extern StringSplit splitAny(StringView string, StringView delimiters);
+
+/// Parses an integer at the start of a given string, which may be preceded by whitespace and a sign, and
+/// converts it to 64-bit integer. When \c base is zero, it is detected from "0x" (hexadecimal) or "0" (octal)
+/// prefix, otherwise it must be between 2 and 36. Parsing does not depend on the current locale. Returns
+/// the number of parsed characters, or zero if there is no number or it does not fit into 64-bit integer,
+/// in which case \c dest is not modified. Empty string, "0x" prefix without hexadecimal digits and octal
+/// number followed by "8" or "9" (e.g. "08") are not numbers.
+extern String::Length parseInt(int64_t& dest, StringView string, int32_t base = 0);
+
+/// Parses a floating-point number at the start of a given string, which may be preceded by whitespace and
+/// a sign, and converts it to the nearest 32-bit floating-point number. Decimal numbers with an optional
+/// exponent, hexadecimal numbers with "0x" prefix and an optional binary exponent, as well as "inf",
+/// "infinity" and "nan" without case-sensitivity are accepted, while a decimal point is always ".",
+/// regardless of the current locale. Returns the number of parsed characters, or zero if there is no
+/// number, in which case \c dest is not modified.
+extern String::Length parseFloat(float& dest, StringView string);
+
+/// Parses a floating-point number at the start of a given string and converts it to the nearest 64-bit
+/// floating-point number, same as \c parseFloat() does.
+extern String::Length parseDouble(double& dest, StringView string);
+
+/// Parses a given string and converts it to 64-bit integer (see \c parseInt()). Any characters after the
+/// number are ignored. Returns \c false if the string does not start with a number.
+extern bool strToInt(int64_t& dest, StringView string, int32_t base = 0);
 
 /// Parses a given string and converts it to 64-bit integer. If the string contains invalid character
 /// sequence, returns the specified default value instead.
-extern int64_t strToInt(String const& string, int64_t defaultValue = 0, int32_t base = 0);
+extern int64_t strToInt(StringView string, int64_t defaultValue = 0, int32_t base = 0);
 
-/// Creates a new string instance representing a 64-bit integer value.
+/// Appends a 64-bit integer value in the given base (from 2 to 36) to the string, writing digits directly into
+/// the string's characters. Digits above nine are written as lower-case letters, while negative values are
+/// preceded by "-". If the base is invalid or a memory allocation failure occurs, then an error bit will be
+/// set and the given string will be polluted. Returns the same string that was passed as first parameter for
+/// chaining.
+extern String& appendInt(String& string, int64_t value, int32_t base = 10);
+
+/// Appends an unsigned 64-bit integer value to the string, same as \c appendInt() does.
+extern String& appendUInt(String& string, uint64_t value, int32_t base = 10);
+
+/// Creates a new string instance representing a 64-bit integer value (see \c appendInt()).
 extern String intToStr(int64_t value, int32_t base = 10);
 
-/// Parses a given string and converts it to 32-bit floating-point number.
-extern bool strToFloat(float& dest, String const& string);
+/// Creates a new string instance representing an unsigned 64-bit integer value (see \c appendInt()).
+extern String uintToStr(uint64_t value, int32_t base = 10);
 
-/// Parses a given string and converts it to 32-bit floating-point number.
-extern float strToFloat(String const& string, float defaultValue = 0.0f);
+#ifdef __SIZEOF_INT128__
+  /// Appends a 128-bit integer value to the string, same as \c appendInt() does.
+  extern String& appendInt128(String& string, __int128 value, int32_t base = 10);
 
-/// Creates a new string instance representing a 32-bit floating-point number.
-extern String floatToStr(float value);
+  /// Appends an unsigned 128-bit integer value to the string, same as \c appendInt() does.
+  extern String& appendUInt128(String& string, unsigned __int128 value, int32_t base = 10);
 
-/// Parses a given string and converts it to 32-bit floating-point number.
-extern bool strToDouble(double& dest, String const& string);
+  /// Creates a new string instance representing a 128-bit integer value (see \c appendInt()).
+  extern String int128ToStr(__int128 value, int32_t base = 10);
+
+  /// Creates a new string instance representing an unsigned 128-bit integer value (see \c appendInt()).
+  extern String uint128ToStr(unsigned __int128 value, int32_t base = 10);
+#endif
+
+/// Parses a given string and converts it to 32-bit floating-point number (see \c parseFloat()). Any
+/// characters after the number are ignored.
+extern bool strToFloat(float& dest, StringView string);
 
 /// Parses a given string and converts it to 32-bit floating-point number.
-extern double strToDouble(String const& string, double defaultValue = 0.0);
+extern float strToFloat(StringView string, float defaultValue = 0.0f);
+
+/// Appends a 32-bit floating-point number to the string, writing it directly into the string's characters.
+/// When \c precision is negative, the shortest sequence of digits is used that parses back to exactly the
+/// same number. Otherwise, the number is rounded exactly to the given number of digits after the decimal
+/// point (or significant digits for FloatFormat::General), same as "printf" does. Decimal point is always
+/// ".", regardless of the current locale. If a memory allocation failure occurs, then an error bit will be
+/// set and the given string will be polluted. Returns the same string that was passed as first parameter
+/// for chaining.
+extern String& appendFloat(String& string, float value, FloatFormat format = FloatFormat::General,
+  int32_t precision = -1);
+
+/// Creates a new string instance representing a 32-bit floating-point number (see \c appendFloat()).
+extern String floatToStr(float value, FloatFormat format = FloatFormat::General, int32_t precision = -1);
+
+/// Parses a given string and converts it to 64-bit floating-point number (see \c parseDouble()). Any
+/// characters after the number are ignored.
+extern bool strToDouble(double& dest, StringView string);
+
+/// Parses a given string and converts it to 64-bit floating-point number.
+extern double strToDouble(StringView string, double defaultValue = 0.0);
+
+/// Appends a 64-bit floating-point number to the string, same as \c appendFloat() does.
+extern String& appendDouble(String& string, double value, FloatFormat format = FloatFormat::General,
+  int32_t precision = -1);
 
-/// Creates a new string instance representing a 32-bit floating-point number.
-extern String doubleToStr(double value);
+/// Creates a new string instance representing a 64-bit floating-point number (see \c appendFloat()).
+extern String doubleToStr(double value, FloatFormat format = FloatFormat::General, int32_t precision = -1);
 
 /// Converts the specified ANSI-based string character codes to upper case.
 extern String upperCase(String const& string);
@@ -936,17 +1287,18 @@ extern String lowerCase(String const& string);
 
 // Unicode conversion utilities.
 
-/// Converts source UTF-16 text to UTF-8 with validation. Returns the actual number of bytes written.
-/// If \c dest is NULL, then just calculates number of characters required.
-/// In case of overflow, this function will not write beyond String::MaxLength bytes and will
-/// return resulting length that is greater than MaxLength.
+/// Converts source UTF-16 text to UTF-8 with validation, where each unpaired surrogate is replaced with
+/// U+FFFD. Returns the actual number of bytes written. If \c dest is NULL, then just calculates the exact
+/// number of characters required. In case of overflow, this function will not write beyond
+/// String::MaxLength bytes and will return resulting length that is greater than MaxLength.
 extern String::Length convertUTF16ToUTF8(char* dest, WideString::WideChar const* source,
   WideString::Length sourceLength);
 
-/// Converts source UTF-8 text to UTF-16 with validation. Returns the actual number of bytes written.
-/// If \c dest is NULL, then just calculates number of characters required.
-/// In case of overflow, this function will not write beyond WideString::MaxLength bytes and will
-/// return resulting length that is greater than WideString::MaxLength.
+/// Converts source UTF-8 text to UTF-16 with validation, where each maximal part of an ill-formed sequence
+/// is replaced with U+FFFD. Returns the actual number of characters written. If \c dest is NULL, then just
+/// calculates the exact number of characters required. In case of overflow, this function will not write
+/// beyond WideString::MaxLength characters and will return resulting length that is greater than
+/// WideString::MaxLength.
 extern WideString::Length convertUTF8ToUTF16(WideString::WideChar* dest, char const* source,
   String::Length sourceLength);
 
@@ -1000,5 +1352,68 @@ struct TextComparer
   String::Length operator () (String const& left, String const& right) const;
 };
 
+/// Case-sensitive string hasher, which can be used with HashMap for both String and HashedString keys.
+struct StringHasher
+{
+  /// Computes hash of the string with case-sensitivity.
+  size_t operator () (String const& value) const;
+
+  /// Tests whether two strings are the same with case-sensitivity.
+  bool operator () (String const& left, String const& right) const;
+
+  /// Returns cached hash of the string.
+  size_t operator () (HashedString const& value) const;
+
+  /// Tests whether two hashed strings are the same, comparing their cached hashes first.
+  bool operator () (HashedString const& left, HashedString const& right) const;
+};
+
+/// Case-insensitive string hasher, which can be used with HashMap.
+struct TextHasher
+{
+  /// Computes hash of the string without case-sensitivity.
+  size_t operator () (String const& value) const;
+
+  /// Tests whether two strings are the same without case-sensitivity.
+  bool operator () (String const& left, String const& right) const;
+};
+
 } // namespace utility
+
+// Default hashing functors.
+
+/// Strings are hashed by their characters with case-sensitivity, same as \c utility::StringHasher does.
+template <>
+struct DefaultHasher<String> : utility::StringHasher
+{
+};
+
+/// Hashed strings use their cached hash, same as \c utility::StringHasher does.
+template <>
+struct DefaultHasher<HashedString> : utility::StringHasher
+{
+};
+
+/// String views are hashed by the characters they refer to with case-sensitivity.
+template <>
+struct DefaultHasher<StringView>
+{
+  /// Computes hash of the characters in the view.
+  size_t operator () (StringView const& value) const;
+
+  /// Tests whether two views refer to the same characters.
+  bool operator () (StringView const& left, StringView const& right) const;
+};
+
+/// Wide strings are hashed by their characters with case-sensitivity.
+template <>
+struct DefaultHasher<WideString>
+{
+  /// Computes hash of the characters in the string.
+  size_t operator () (WideString const& value) const;
+
+  /// Tests whether two strings are the same with case-sensitivity.
+  bool operator () (WideString const& left, WideString const& right) const;
+};
+
 } // namespace trl
\ No newline at end of file
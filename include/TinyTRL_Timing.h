@@ -31,8 +31,13 @@ extern void timingSleep(uint32_t milliseconds);
 extern void timingSleepUS(uint32_t microseconds);
 
 /// Returns raw number of microseconds elapsed since initialization.
+/// This function is thread-safe and all threads share the same starting point.
 extern TickCount timingTickCountUS();
 
+/// Returns raw number of nanoseconds elapsed since initialization.
+/// This function is thread-safe and all threads share the same starting point.
+extern TickCount timingTickCountNS();
+
 /// Returns number of milliseconds elapsed since initialization.
 extern uint32_t timingTickCount();
 
@@ -56,10 +56,25 @@
 //  #define __PLATFORM_BIG_ENDIAN
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  // x86 / x64: SSE2 vector instructions are available.
+  #define __PLATFORM_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+  // ARM: NEON vector instructions are available.
+  #define __PLATFORM_NEON
+#endif
+
+// Memory of long strings is allocated with PoolAllocator instead of C heap functions when this is defined,
+// either here or in project settings.
+//#define __STRINGS_POOL_ALLOCATOR
+
 #ifdef _MSC_VER
   // Framework uses boolean bit flags by design, suppress MSVC warning about it.
   #pragma warning(disable: 4800)
 
   // Disable useless CRT security warnings.
   #pragma warning(disable: 4996)
+
+  // Compiler intrinsics such as _BitScanForward.
+  #include <intrin.h>
 #endif
\ No newline at end of file
@@ -0,0 +1,257 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// TinyTRL_Atomics.h
+// Atomic operations on variables shared between threads, which are used by the library sources. This header
+// is internal and is not part of the public interface.
+#pragma once
+
+#include "TinyTRL_TypeDef.h"
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <sched.h>
+#endif
+
+namespace trl {
+
+// Number of iterations of a spin loop that only hint the processor before giving up the time slice.
+static uint32_t constexpr const AtomicSpinCount = 64;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+  // Atomically reads a value shared between threads with acquire semantics.
+  inline uint32_t atomicLoad(uint32_t const& variable)
+  {
+    return static_cast<uint32_t>(InterlockedCompareExchange(
+      reinterpret_cast<LONG volatile*>(const_cast<uint32_t*>(&variable)), 0, 0));
+  }
+
+  // Atomically reads a value shared between threads without ordering, such as a flag or a counter.
+  inline uint32_t atomicLoadRelaxed(uint32_t const& variable)
+  {
+    return *static_cast<uint32_t const volatile*>(&variable);
+  }
+
+  // Atomically reads a 64-bit value shared between threads without ordering, such as a counter.
+  inline uint64_t atomicLoadRelaxed(uint64_t const& variable)
+  {
+  #ifdef __PLATFORM_X64
+    return *static_cast<uint64_t const volatile*>(&variable);
+  #else
+    // Aligned 64-bit reads are not atomic on 32-bit platforms.
+    return static_cast<uint64_t>(InterlockedCompareExchange64(
+      reinterpret_cast<LONG64 volatile*>(const_cast<uint64_t*>(&variable)), 0, 0));
+  #endif
+  }
+
+  // Atomically writes a value shared between threads with release semantics.
+  inline void atomicStore(uint32_t& variable, uint32_t const value)
+  {
+    InterlockedExchange(reinterpret_cast<LONG volatile*>(&variable), static_cast<LONG>(value));
+  }
+
+  // Atomically replaces the value if it matches the expected one. Returns true if the value was replaced.
+  inline bool atomicCompareExchange(uint32_t& variable, uint32_t const expected, uint32_t const desired)
+  {
+    return static_cast<uint32_t>(InterlockedCompareExchange(reinterpret_cast<LONG volatile*>(&variable),
+      static_cast<LONG>(desired), static_cast<LONG>(expected))) == expected;
+  }
+
+  // Atomically replaces the 64-bit value if it matches the expected one. Returns true if the value was replaced.
+  inline bool atomicCompareExchange(uint64_t& variable, uint64_t const expected, uint64_t const desired)
+  {
+    return static_cast<uint64_t>(InterlockedCompareExchange64(reinterpret_cast<LONG64 volatile*>(&variable),
+      static_cast<LONG64>(desired), static_cast<LONG64>(expected))) == expected;
+  }
+
+  // Atomically adds the value to a variable without ordering and returns the previous value.
+  inline uint32_t atomicAdd(uint32_t& variable, uint32_t const value)
+  {
+    return static_cast<uint32_t>(InterlockedExchangeAdd(reinterpret_cast<LONG volatile*>(&variable),
+      static_cast<LONG>(value)));
+  }
+
+  // Atomically adds the value to a 64-bit variable without ordering and returns the previous value.
+  inline uint64_t atomicAdd(uint64_t& variable, uint64_t const value)
+  {
+    return static_cast<uint64_t>(InterlockedExchangeAdd64(reinterpret_cast<LONG64 volatile*>(&variable),
+      static_cast<LONG64>(value)));
+  }
+
+  // Prevents memory reads that precede the fence from being reordered with reads and writes that follow it.
+  inline void atomicFenceAcquire()
+  {
+    MemoryBarrier();
+  }
+
+  // Atomically reads a pointer shared between threads with acquire semantics.
+  template <typename Type>
+  inline Type* atomicLoad(Type* const& variable)
+  {
+    return static_cast<Type*>(InterlockedCompareExchangePointer(
+      reinterpret_cast<PVOID volatile*>(const_cast<Type**>(&variable)), nullptr, nullptr));
+  }
+
+  // Atomically writes a pointer shared between threads with release semantics.
+  template <typename Type>
+  inline void atomicStore(Type*& variable, Type* const value)
+  {
+    InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&variable),
+      const_cast<void*>(static_cast<void const*>(value)));
+  }
+
+  // Atomically replaces the pointer if it matches the expected one. Returns true if the pointer was replaced.
+  template <typename Type>
+  inline bool atomicCompareExchange(Type*& variable, Type* const expected, Type* const desired)
+  {
+    return InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&variable),
+      const_cast<void*>(static_cast<void const*>(desired)),
+      const_cast<void*>(static_cast<void const*>(expected))) == expected;
+  }
+
+  // Tells the processor that the current thread is waiting in a spin loop.
+  inline void atomicPause()
+  {
+    YieldProcessor();
+  }
+
+  // Gives the rest of the time slice of the current thread to other threads.
+  inline void atomicYield()
+  {
+    SwitchToThread();
+  }
+
+#else
+
+  // Atomically reads a value shared between threads with acquire semantics.
+  inline uint32_t atomicLoad(uint32_t const& variable)
+  {
+    return __atomic_load_n(&variable, __ATOMIC_ACQUIRE);
+  }
+
+  // Atomically reads a value shared between threads without ordering, such as a flag or a counter.
+  inline uint32_t atomicLoadRelaxed(uint32_t const& variable)
+  {
+    return __atomic_load_n(&variable, __ATOMIC_RELAXED);
+  }
+
+  // Atomically reads a 64-bit value shared between threads without ordering, such as a counter.
+  inline uint64_t atomicLoadRelaxed(uint64_t const& variable)
+  {
+    return __atomic_load_n(&variable, __ATOMIC_RELAXED);
+  }
+
+  // Atomically writes a value shared between threads with release semantics.
+  inline void atomicStore(uint32_t& variable, uint32_t const value)
+  {
+    __atomic_store_n(&variable, value, __ATOMIC_RELEASE);
+  }
+
+  // Atomically replaces the value if it matches the expected one. Returns true if the value was replaced.
+  inline bool atomicCompareExchange(uint32_t& variable, uint32_t expected, uint32_t const desired)
+  {
+    return __atomic_compare_exchange_n(&variable, &expected, desired, false, __ATOMIC_ACQ_REL,
+      __ATOMIC_ACQUIRE);
+  }
+
+  // Atomically replaces the 64-bit value if it matches the expected one. Returns true if the value was replaced.
+  inline bool atomicCompareExchange(uint64_t& variable, uint64_t expected, uint64_t const desired)
+  {
+    return __atomic_compare_exchange_n(&variable, &expected, desired, false, __ATOMIC_ACQ_REL,
+      __ATOMIC_ACQUIRE);
+  }
+
+  // Atomically adds the value to a variable without ordering and returns the previous value.
+  inline uint32_t atomicAdd(uint32_t& variable, uint32_t const value)
+  {
+    return __atomic_fetch_add(&variable, value, __ATOMIC_RELAXED);
+  }
+
+  // Atomically adds the value to a 64-bit variable without ordering and returns the previous value.
+  inline uint64_t atomicAdd(uint64_t& variable, uint64_t const value)
+  {
+    return __atomic_fetch_add(&variable, value, __ATOMIC_RELAXED);
+  }
+
+  // Prevents memory reads that precede the fence from being reordered with reads and writes that follow it.
+  inline void atomicFenceAcquire()
+  {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  }
+
+  // Atomically reads a pointer shared between threads with acquire semantics.
+  template <typename Type>
+  inline Type* atomicLoad(Type* const& variable)
+  {
+    return __atomic_load_n(&variable, __ATOMIC_ACQUIRE);
+  }
+
+  // Atomically writes a pointer shared between threads with release semantics.
+  template <typename Type>
+  inline void atomicStore(Type*& variable, Type* const value)
+  {
+    __atomic_store_n(&variable, value, __ATOMIC_RELEASE);
+  }
+
+  // Atomically replaces the pointer if it matches the expected one. Returns true if the pointer was replaced.
+  template <typename Type>
+  inline bool atomicCompareExchange(Type*& variable, Type* expected, Type* const desired)
+  {
+    return __atomic_compare_exchange_n(&variable, &expected, desired, false, __ATOMIC_ACQ_REL,
+      __ATOMIC_ACQUIRE);
+  }
+
+  // Tells the processor that the current thread is waiting in a spin loop.
+  inline void atomicPause()
+  {
+  #if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+  #elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+  #endif
+  }
+
+  // Gives the rest of the time slice of the current thread to other threads.
+  inline void atomicYield()
+  {
+    sched_yield();
+  }
+
+#endif
+
+// Acquires a spin lock, which is zero when unlocked. The processor is hinted while waiting, until after a number
+// of attempts the time slice is given up, so that a thread holding the lock can run if it has been preempted.
+inline void atomicLock(uint32_t& lock)
+{
+  for (uint32_t spins = 0; atomicLoad(lock) || !atomicCompareExchange(lock, 0, 1);)
+    if (spins < AtomicSpinCount)
+    {
+      atomicPause();
+      ++spins;
+    }
+    else
+      atomicYield();
+}
+
+// Releases a spin lock that has been acquired with atomicLock().
+inline void atomicUnlock(uint32_t& lock)
+{
+  atomicStore(lock, 0);
+}
+
+} // namespace trl
@@ -0,0 +1,461 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// TinyTRL_Containers.cpp
+#include "TinyTRL_Containers.h"
+#include "TinyTRL_Atomics.h"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <pthread.h>
+  #include <unistd.h>
+#endif
+
+namespace trl {
+
+// Size of the smallest block in bytes, which is served by the first size class.
+static size_t constexpr const PoolMinBlockSize = 16;
+
+// Number of size classes, from PoolMinBlockSize to PoolAllocator::MaxBlockSize.
+static uint32_t constexpr const PoolClassCount = 12;
+
+// Largest alignment that is guaranteed for blocks of the pool.
+static size_t constexpr const PoolAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+// Approximate number of bytes in a batch of blocks moved between a thread cache and the depot.
+static size_t constexpr const PoolBatchBytes = 16384;
+
+// Limits for number of blocks in a batch.
+static uint32_t constexpr const PoolMinBatchCount = 2;
+static uint32_t constexpr const PoolMaxBatchCount = 64;
+
+static_assert(PoolMinBlockSize << (PoolClassCount - 1) == PoolAllocator::MaxBlockSize);
+
+// Free block of memory.
+struct PoolBlock
+{
+  // Next block in the same list or batch.
+  PoolBlock* next;
+
+  // First block of the next batch, used only by the first block of a batch in the depot.
+  PoolBlock* nextBatch;
+};
+
+// Free blocks of a single size class cached by a thread.
+struct PoolList
+{
+  // First free block.
+  PoolBlock* head;
+
+  // Number of free blocks.
+  uint32_t count;
+
+  // Counters that have not been added to the depot yet.
+  uint64_t allocations;
+  uint64_t releases;
+};
+
+// Free blocks of a single size class shared by all threads.
+struct PoolDepot
+{
+  // Batches of free blocks.
+  PoolBlock* batches;
+
+  // Total number of free blocks in all batches.
+  uint64_t blocks;
+
+  // Counters that have been added by the threads.
+  uint64_t allocations;
+  uint64_t releases;
+
+  // Non-zero while the depot is being accessed by a thread.
+  uint32_t lock;
+};
+
+// Free blocks cached by a thread, which are returned to the depot when the thread exits.
+struct PoolCache
+{
+  // Lists for every size class.
+  PoolList lists[PoolClassCount];
+
+  // Whether the thread is exiting, in which case no blocks are kept in the cache.
+  bool released;
+
+  ~PoolCache();
+};
+
+// Forward declarations.
+
+// Returns size class that serves blocks of the given size.
+static uint32_t poolSizeClass(size_t numBytes);
+
+// Returns number of blocks in a batch of the given size class.
+static uint32_t poolBatchCount(uint32_t sizeClass);
+
+// Acquires the lock of a depot, adding counters of the given list to it.
+static PoolDepot& poolLock(uint32_t sizeClass, PoolList& list);
+
+// Releases the lock of a depot.
+static void poolUnlock(PoolDepot& depot);
+
+// Fills an empty list with a batch of blocks from the depot, or with new blocks if the depot is empty.
+static bool poolRefill(PoolList& list, uint32_t sizeClass);
+
+// Moves the given number of blocks from the list to the depot as a single batch.
+static void poolFlush(PoolList& list, uint32_t sizeClass, uint32_t count);
+
+// Moves all blocks from the list to the depot.
+static void poolDrain(PoolList& list, uint32_t sizeClass);
+
+// Global variables.
+
+// Shared free blocks for every size class.
+static PoolDepot poolDepots[PoolClassCount];
+
+// Number of allocations that have been passed to operator new.
+static uint64_t poolLargeAllocations = 0;
+
+// Number of bytes that have been requested for blocks.
+static uint64_t poolReservedBytes = 0;
+
+// Free blocks cached by the current thread.
+static thread_local PoolCache poolCache;
+
+// Memory resource of the innermost scope on the current thread.
+static thread_local MemoryResource* resourceCurrent = nullptr;
+
+// Containers members.
+
+int32_t Containers::processorCount() noexcept
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return static_cast<int32_t>(info.dwNumberOfProcessors);
+#else
+  long const count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? static_cast<int32_t>(count) : 1;
+#endif
+}
+
+void Containers::runParallel(ParallelTask const task, void* const context, int32_t const count) noexcept
+{
+  // Part of the task that is run on its own thread.
+  struct Part
+  {
+    ParallelTask task;
+    void* context;
+    int32_t index;
+    bool started;
+
+  #ifdef _WIN32
+    HANDLE thread;
+
+    static DWORD WINAPI run(LPVOID const parameter)
+    {
+      Part const* const part = static_cast<Part const*>(parameter);
+      part->task(part->context, part->index);
+      return 0;
+    }
+  #else
+    pthread_t thread;
+
+    static void* run(void* const parameter)
+    {
+      Part const* const part = static_cast<Part const*>(parameter);
+      part->task(part->context, part->index);
+      return nullptr;
+    }
+  #endif
+  };
+
+  Part parts[MaxParallelThreads];
+  int32_t const threads = math::min(count, MaxParallelThreads);
+
+  for (int32_t i = 1; i < threads; ++i)
+  {
+    Part& part = parts[i];
+    part.task = task;
+    part.context = context;
+    part.index = i;
+  #ifdef _WIN32
+    part.thread = CreateThread(nullptr, 0, Part::run, &part, 0, nullptr);
+    part.started = part.thread != nullptr;
+  #else
+    part.started = pthread_create(&part.thread, nullptr, Part::run, &part) == 0;
+  #endif
+  }
+
+  if (count > 0)
+    task(context, 0);
+
+  // Parts that could not be started on their own thread are run on this one.
+  for (int32_t i = 1; i < count; ++i)
+    if (i >= threads || !parts[i].started)
+      task(context, i);
+
+  for (int32_t i = 1; i < threads; ++i)
+    if (parts[i].started)
+    {
+    #ifdef _WIN32
+      WaitForSingleObject(parts[i].thread, INFINITE);
+      CloseHandle(parts[i].thread);
+    #else
+      pthread_join(parts[i].thread, nullptr);
+    #endif
+    }
+}
+
+// PoolAllocator members.
+
+void* PoolAllocator::alloc(size_t const numBytes, size_t const alignment) noexcept
+{
+  if (numBytes > MaxBlockSize || alignment > PoolAlignment)
+  {
+    atomicAdd(poolLargeAllocations, 1);
+
+    if (alignment > PoolAlignment)
+      return ::operator new(numBytes, static_cast<std::align_val_t>(alignment), std::nothrow);
+    else
+      return ::operator new(numBytes, std::nothrow);
+  }
+  uint32_t const sizeClass = poolSizeClass(numBytes);
+  PoolList& list = poolCache.lists[sizeClass];
+
+  if (!list.head && !poolRefill(list, sizeClass))
+    return nullptr;
+
+  PoolBlock* const block = list.head;
+  list.head = block->next;
+  --list.count;
+  ++list.allocations;
+
+  if (poolCache.released)
+    poolDrain(list, sizeClass);
+
+  return block;
+}
+
+void PoolAllocator::free(void* const data, size_t const numBytes, size_t const alignment) noexcept
+{
+  if (!data)
+    return;
+
+  if (numBytes > MaxBlockSize || alignment > PoolAlignment)
+  {
+    if (alignment > PoolAlignment)
+      ::operator delete(data, static_cast<std::align_val_t>(alignment));
+    else
+      ::operator delete(data);
+    return;
+  }
+  uint32_t const sizeClass = poolSizeClass(numBytes);
+  PoolList& list = poolCache.lists[sizeClass];
+
+  PoolBlock* const block = static_cast<PoolBlock*>(data);
+  block->next = list.head;
+  list.head = block;
+  ++list.count;
+  ++list.releases;
+
+  // Keep one batch in the cache, so that alternating allocations and releases do not touch the depot.
+  if (uint32_t const batchCount = poolBatchCount(sizeClass); list.count >= batchCount * 2)
+    poolFlush(list, sizeClass, batchCount);
+
+  if (poolCache.released)
+    poolDrain(list, sizeClass);
+}
+
+PoolStatistics PoolAllocator::statistics() noexcept
+{
+  PoolStatistics stats = {};
+
+  for (uint32_t i = 0; i < PoolClassCount; ++i)
+  {
+    PoolDepot& depot = poolLock(i, poolCache.lists[i]);
+
+    stats.allocations += depot.allocations;
+    stats.releases += depot.releases;
+    stats.depotBlocks += depot.blocks;
+
+    poolUnlock(depot);
+  }
+  stats.largeAllocations = atomicLoadRelaxed(poolLargeAllocations);
+  stats.reservedBytes = atomicLoadRelaxed(poolReservedBytes);
+
+  return stats;
+}
+
+// MemoryResource members.
+
+MemoryResource::~MemoryResource()
+{
+}
+
+void* MemoryResource::reallocate(void* const data, size_t const dataBytes, size_t const requestedBytes,
+  size_t const alignment) noexcept
+{
+  void* newData = nullptr;
+
+  if (requestedBytes)
+  {
+    if (!(newData = alloc(requestedBytes, alignment)))
+      return nullptr;
+
+    if (data)
+      ::memcpy(newData, data, math::min(dataBytes, requestedBytes));
+  }
+  if (data)
+    free(data, dataBytes, alignment);
+
+  return newData;
+}
+
+// ResourceScope members.
+
+ResourceScope::ResourceScope(MemoryResource* const resource) noexcept
+: _previous(resourceCurrent)
+{
+  resourceCurrent = resource;
+}
+
+ResourceScope::~ResourceScope()
+{
+  resourceCurrent = _previous;
+}
+
+MemoryResource* ResourceScope::current() noexcept
+{
+  return resourceCurrent;
+}
+
+// PoolCache members.
+
+PoolCache::~PoolCache()
+{
+  released = true;
+
+  for (uint32_t i = 0; i < PoolClassCount; ++i)
+    poolDrain(lists[i], i);
+}
+
+// Helper functions.
+
+uint32_t poolSizeClass(size_t const numBytes)
+{
+  if (numBytes <= PoolMinBlockSize)
+    return 0;
+
+  // Round up to the next power of two, where PoolMinBlockSize is 2^4.
+  return static_cast<uint32_t>(64 - math::countLeadingZeros(static_cast<uint64_t>(numBytes - 1)) - 4);
+}
+
+uint32_t poolBatchCount(uint32_t const sizeClass)
+{
+  return math::saturate(static_cast<uint32_t>(PoolBatchBytes / (PoolMinBlockSize << sizeClass)),
+    PoolMinBatchCount, PoolMaxBatchCount);
+}
+
+PoolDepot& poolLock(uint32_t const sizeClass, PoolList& list)
+{
+  PoolDepot& depot = poolDepots[sizeClass];
+
+  atomicLock(depot.lock);
+  depot.allocations += list.allocations;
+  depot.releases += list.releases;
+  list.allocations = list.releases = 0;
+
+  return depot;
+}
+
+void poolUnlock(PoolDepot& depot)
+{
+  atomicUnlock(depot.lock);
+}
+
+bool poolRefill(PoolList& list, uint32_t const sizeClass)
+{
+  PoolDepot& depot = poolLock(sizeClass, list);
+
+  if (PoolBlock* const batch = depot.batches)
+  {
+    depot.batches = batch->nextBatch;
+
+    uint32_t count = 0;
+    for (PoolBlock* block = batch; block; block = block->next)
+      ++count;
+
+    depot.blocks -= count;
+    poolUnlock(depot);
+
+    list.head = batch;
+    list.count = count;
+    return true;
+  }
+  poolUnlock(depot);
+
+  // Depot is empty, so carve a new batch out of a single allocation.
+  size_t const blockSize = PoolMinBlockSize << sizeClass;
+  uint32_t const count = poolBatchCount(sizeClass);
+
+  uint8_t* const memory = static_cast<uint8_t*>(::operator new(blockSize * count, std::nothrow));
+  if (!memory)
+    return false;
+
+  atomicAdd(poolReservedBytes, blockSize * count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    PoolBlock* const block = reinterpret_cast<PoolBlock*>(memory + blockSize * i);
+    block->next = i + 1 < count ? reinterpret_cast<PoolBlock*>(memory + blockSize * (i + 1)) : nullptr;
+  }
+  list.head = reinterpret_cast<PoolBlock*>(memory);
+  list.count = count;
+  return true;
+}
+
+void poolFlush(PoolList& list, uint32_t const sizeClass, uint32_t const count)
+{
+  PoolBlock* const batch = list.head;
+
+  PoolBlock* last = batch;
+  for (uint32_t i = 1; i < count; ++i)
+    last = last->next;
+
+  list.head = last->next;
+  list.count -= count;
+  last->next = nullptr;
+
+  PoolDepot& depot = poolLock(sizeClass, list);
+
+  batch->nextBatch = depot.batches;
+  depot.batches = batch;
+  depot.blocks += count;
+
+  poolUnlock(depot);
+}
+
+void poolDrain(PoolList& list, uint32_t const sizeClass)
+{
+  uint32_t const batchCount = poolBatchCount(sizeClass);
+
+  while (list.count)
+    poolFlush(list, sizeClass, math::min(list.count, batchCount));
+
+  // Add remaining counters to the depot.
+  poolUnlock(poolLock(sizeClass, list));
+}
+
+} // namespace trl
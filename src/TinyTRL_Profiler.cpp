@@ -0,0 +1,424 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include "TinyTRL_Profiler.h"
+#include "TinyTRL_Containers.h"
+#include "TinyTRL_Atomics.h"
+
+namespace trl {
+
+// Event recorded for a completed scope.
+struct ProfileEvent
+{
+  // Name of the scope.
+  char const* name;
+
+  // Time in nanoseconds when the scope has started.
+  TickCount start;
+
+  // Duration of the scope in nanoseconds.
+  TickCount duration;
+};
+
+// Copy of an event taken when writing the results.
+struct ProfileSample
+{
+  // Recorded event.
+  ProfileEvent event;
+
+  // Number of the thread that has recorded the event.
+  uint32_t thread;
+};
+
+// Ring buffer of events recorded by a single thread. Only the owning thread writes events, while other
+// threads may read them concurrently.
+struct ProfileThread
+{
+  // Next buffer in the global list, which does not change after the buffer has been published.
+  ProfileThread* next;
+
+  // Storage for events.
+  ProfileEvent* events;
+
+  // Capacity of the buffer minus one, where capacity is a power of two.
+  uint32_t mask;
+
+  // Sequential number of the thread, starting from one.
+  uint32_t id;
+
+  // Total number of events written (modulo 2^32), published after each event is written.
+  uint32_t head;
+
+  // Number of events (modulo 2^32) that have been discarded by a reset.
+  uint32_t tail;
+
+  // Non-zero while the buffer is being used by a running thread.
+  uint32_t owned;
+};
+
+// Releases thread's buffer when the thread exits, so that it can be reused by another thread.
+struct ProfileThreadRelease
+{
+  // Buffer owned by the current thread.
+  ProfileThread* thread = nullptr;
+
+  ~ProfileThreadRelease();
+};
+
+// Forward declarations.
+
+// Finds or creates an event buffer for the current thread.
+static ProfileThread* profilerAttach();
+
+// Copies all available events from all threads.
+static bool profilerCollect(Array<ProfileSample>& samples);
+
+// Appends the given number of nanoseconds to the string as microseconds with three decimal places.
+static void profilerAppendMicroseconds(String& string, TickCount nanoseconds);
+
+// Pads a column of the report, which starts at the given position and extends to the end of the line, with
+// spaces up to the absolute value of the given width. Positive width aligns contents to the right, while
+// negative width aligns them to the left.
+static void profilerAlignColumn(String& line, String::Length start, String::Length width);
+
+// Global variables.
+
+// List of all event buffers that have been created.
+static ProfileThread* profilerThreads = nullptr;
+
+// Number of event buffers that have been created.
+static uint32_t profilerThreadCount = 0;
+
+// Whether events are being recorded.
+static uint32_t profilerEnabledFlag = 1;
+
+// Capacity for buffers that are going to be created.
+static uint32_t profilerThreadCapacity = ProfilerDefaultCapacity;
+
+// Event buffer of the current thread.
+static thread_local ProfileThread* profilerCurrent = nullptr;
+
+// Releases event buffer of the current thread on exit.
+static thread_local ProfileThreadRelease profilerRelease;
+
+// ProfileScope members.
+
+ProfileScope::ProfileScope(char const* const name) noexcept
+: _name(profilerEnabled() ? name : nullptr),
+  _start(_name ? timingTickCountNS() : 0)
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+  if (_name)
+    profilerRecord(_name, _start, timingTickCountNS() - _start);
+}
+
+// ProfileThreadRelease members.
+
+ProfileThreadRelease::~ProfileThreadRelease()
+{
+  if (thread)
+  {
+    profilerCurrent = nullptr;
+    atomicStore(thread->owned, 0);
+  }
+}
+
+// Global functions.
+
+void profilerEnable(bool const enable)
+{
+  atomicStore(profilerEnabledFlag, enable ? 1 : 0);
+}
+
+bool profilerEnabled()
+{
+  return atomicLoadRelaxed(profilerEnabledFlag) != 0;
+}
+
+void profilerCapacity(uint32_t const capacity)
+{
+  atomicStore(profilerThreadCapacity, math::ceilPowerOfTwo(math::saturate(capacity, 2u, 0x10000000u)));
+}
+
+void profilerRecord(char const* const name, TickCount const start, TickCount const duration)
+{
+  ProfileThread* thread = profilerCurrent;
+  if (!thread && !(thread = profilerAttach()))
+    return; // Memory allocation failure.
+
+  // The owning thread is the only writer, so its own counter can be read without synchronization.
+  uint32_t const head = thread->head;
+
+  ProfileEvent& event = thread->events[head & thread->mask];
+  event.name = name;
+  event.start = start;
+  event.duration = duration;
+
+  atomicStore(thread->head, head + 1);
+}
+
+void profilerReset()
+{
+  for (ProfileThread* thread = atomicLoad(profilerThreads); thread; thread = thread->next)
+    atomicStore(thread->tail, atomicLoad(thread->head));
+}
+
+bool profilerWriteReport(Stream& stream)
+{
+  Array<ProfileSample> samples;
+  if (!profilerCollect(samples))
+    return false;
+
+  // Group events by name, ordering durations within each group.
+  samples.sort(0, Containers::MaxLength, [](ProfileSample const& left, ProfileSample const& right)
+  {
+    if (String::Length const res = utility::compareStr(left.event.name, right.event.name))
+      return res < 0 ? -1 : 1;
+    else
+      return left.event.duration < right.event.duration ? -1 : (left.event.duration > right.event.duration);
+  });
+
+  String line;
+  char const* const headers[] = {"Count", "Min (us)", "Mean (us)", "P50 (us)", "P99 (us)", "Max (us)"};
+
+  line.append("Name");
+  profilerAlignColumn(line, 0, -40);
+
+  for (int32_t i = 0; i < 6; ++i)
+  {
+    String::Length const start = line.length();
+    line.append(' ').append(headers[i]);
+    profilerAlignColumn(line, start, i > 0 ? 13 : 11);
+  }
+  line.append('\n');
+  if (!line)
+  {
+    stream.pollute();
+    return false; // Memory allocation failure
+  }
+  stream.write(line);
+
+  for (Containers::Length first = 0, last; first < samples.length(); first = last)
+  {
+    char const* const name = samples[first].event.name;
+    TickCount total = 0;
+
+    for (last = first; last < samples.length() && (samples[last].event.name == name ||
+      utility::sameStr(samples[last].event.name, name)); ++last)
+      total += samples[last].event.duration;
+
+    Containers::Length const count = last - first;
+
+    line.clear();
+    line.append(name);
+    profilerAlignColumn(line, 0, -40);
+
+    String::Length start = line.length();
+    utility::appendInt(line.append(' '), count);
+    profilerAlignColumn(line, start, 11);
+
+    start = line.length();
+    profilerAppendMicroseconds(line.append(' '), samples[first].event.duration);
+    profilerAlignColumn(line, start, 13);
+
+    start = line.length();
+    utility::appendDouble(line.append(' '), (static_cast<double>(total) / count) / 1000.0, FloatFormat::Fixed, 3);
+    profilerAlignColumn(line, start, 13);
+
+    start = line.length();
+    profilerAppendMicroseconds(line.append(' '), samples[first + (count - 1) / 2].event.duration);
+    profilerAlignColumn(line, start, 13);
+
+    start = line.length();
+    profilerAppendMicroseconds(line.append(' '), samples[first + ((count - 1) * 99) / 100].event.duration);
+    profilerAlignColumn(line, start, 13);
+
+    start = line.length();
+    profilerAppendMicroseconds(line.append(' '), samples[last - 1].event.duration);
+    profilerAlignColumn(line, start, 13);
+
+    line.append('\n');
+    if (!line)
+    {
+      stream.pollute();
+      return false; // Memory allocation failure
+    }
+    stream.write(line);
+  }
+  return static_cast<bool>(stream);
+}
+
+bool profilerWriteTrace(Stream& stream)
+{
+  Array<ProfileSample> samples;
+  if (!profilerCollect(samples))
+    return false;
+
+  // Output is accumulated in a buffer to avoid writing each event separately.
+  String::Length const bufferLength = 8192;
+  char const* const hexDigits = "0123456789abcdef";
+
+  String buffer;
+  buffer.append("{\"traceEvents\":[");
+
+  for (Containers::Length i = 0; i < samples.length(); ++i)
+  {
+    if (buffer.length() >= bufferLength)
+    {
+      if (!buffer)
+      {
+        stream.pollute();
+        return false; // Memory allocation failure
+      }
+      stream.write(buffer);
+      buffer.clear();
+    }
+    ProfileEvent const& event = samples[i].event;
+
+    buffer.append(i > 0 ? ",\n{\"name\":\"" : "\n{\"name\":\"");
+
+    // Escape the name as a JSON string.
+    for (char const* text = event.name; *text; ++text)
+    {
+      uint8_t const value = static_cast<uint8_t>(*text);
+
+      if (value == '"' || value == '\\')
+        buffer.append('\\').append(static_cast<char>(value));
+      else if (value < 0x20)
+        buffer.append("\\u00").append(hexDigits[value >> 4]).append(hexDigits[value & 0x0F]);
+      else
+        buffer.append(static_cast<char>(value));
+    }
+
+    buffer.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+    utility::appendUInt(buffer, samples[i].thread);
+    profilerAppendMicroseconds(buffer.append(",\"ts\":"), event.start);
+    profilerAppendMicroseconds(buffer.append(",\"dur\":"), event.duration);
+    buffer.append('}');
+  }
+  buffer.append("\n],\"displayTimeUnit\":\"ns\"}\n");
+
+  if (!buffer)
+  {
+    stream.pollute();
+    return false; // Memory allocation failure
+  }
+  stream.write(buffer);
+  return static_cast<bool>(stream);
+}
+
+// Helper functions.
+
+ProfileThread* profilerAttach()
+{
+  ProfileThread* thread = nullptr;
+
+  // Reuse buffer of a thread that has already exited, if there is one.
+  for (ProfileThread* other = atomicLoad(profilerThreads); other && !thread; other = other->next)
+    if (!atomicLoad(other->owned) && atomicCompareExchange(other->owned, 0, 1))
+      thread = other;
+
+  if (!thread)
+  {
+    uint32_t const capacity = atomicLoad(profilerThreadCapacity);
+
+    thread = static_cast<ProfileThread*>(::malloc(sizeof(ProfileThread)));
+    if (!thread)
+      return nullptr;
+
+    if (!(thread->events = static_cast<ProfileEvent*>(::malloc(capacity * sizeof(ProfileEvent)))))
+    {
+      ::free(thread);
+      return nullptr;
+    }
+    thread->mask = capacity - 1;
+    thread->id = atomicAdd(profilerThreadCount, 1) + 1;
+    thread->head = thread->tail = 0;
+    thread->owned = 1;
+
+    // Publish new buffer at the beginning of the list. Buffers are never released, so the list can only
+    // grow and there is no need to worry about reclamation.
+    do {
+      thread->next = atomicLoad(profilerThreads);
+    } while (!atomicCompareExchange(profilerThreads, thread->next, thread));
+  }
+  profilerCurrent = thread;
+  profilerRelease.thread = thread;
+  return thread;
+}
+
+bool profilerCollect(Array<ProfileSample>& samples)
+{
+  for (ProfileThread* thread = atomicLoad(profilerThreads); thread; thread = thread->next)
+  {
+    uint32_t const head = atomicLoad(thread->head);
+    uint32_t const count = math::min(head - atomicLoad(thread->tail), thread->mask + 1);
+    uint32_t const first = head - count;
+
+    Containers::Length const offset = samples.length();
+    if (!samples.length(offset + count))
+      return false; // Memory allocation failure
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      samples[offset + i].event = thread->events[(first + i) & thread->mask];
+      samples[offset + i].thread = thread->id;
+    }
+
+    // Discard events that may have been overwritten while they were being copied.
+    atomicFenceAcquire();
+    uint32_t const written = atomicLoad(thread->head) - first;
+    uint32_t const overwritten = math::min(written > thread->mask + 1 ? written - (thread->mask + 1) : 0u,
+      count);
+
+    if (overwritten)
+      samples.erase(offset, overwritten);
+  }
+  return true;
+}
+
+void profilerAppendMicroseconds(String& string, TickCount const nanoseconds)
+{
+  uint32_t const fraction = static_cast<uint32_t>(nanoseconds % 1000u);
+
+  utility::appendUInt(string, nanoseconds / 1000u).append('.');
+
+  for (uint32_t divisor = 100; divisor > 0; divisor /= 10)
+    string.append(static_cast<char>('0' + fraction / divisor % 10));
+}
+
+void profilerAlignColumn(String& line, String::Length const start, String::Length const width)
+{
+  String::Length const length = line.length() - start;
+  String::Length const padding = (width < 0 ? -width : width) - length;
+
+  if (padding > 0 && line.length(line.length() + padding))
+  {
+    char* const data = line.data() + start;
+
+    if (width > 0)
+    {
+      memmove(data + padding, data, static_cast<size_t>(length));
+      memset(data, ' ', static_cast<size_t>(padding));
+    }
+    else
+      memset(data + length, ' ', static_cast<size_t>(padding));
+  }
+  else if (padding > 0)
+    line.pollute(); // Memory allocation failure
+}
+
+} // namespace trl
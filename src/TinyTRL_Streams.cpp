@@ -26,6 +26,7 @@
   #include <errno.h>
   #include <unistd.h>
   #include <fcntl.h>
+  #include <sys/mman.h>
 #endif
 
 namespace trl {
@@ -39,6 +40,22 @@ static FileStream::Handle const invalidHandle =
 #endif
 ;
 
+// Allocates, reallocates or releases (when new size is zero) a buffer either by using the given memory resource,
+// or C heap functions when the resource is NULL.
+static void* resourceReallocate(MemoryResource* const resource, void* const data, size_t const dataBytes,
+  size_t const requestedBytes)
+{
+  if (resource)
+    return resource->reallocate(data, dataBytes, requestedBytes, alignof(max_align_t));
+
+  if (!requestedBytes)
+  {
+    ::free(data);
+    return nullptr;
+  }
+  return ::realloc(data, requestedBytes);
+}
+
 // Stream members.
 
 Stream::Stream()
@@ -101,8 +118,11 @@ Stream::Offset Stream::copy(Stream& source, Offset const size, Size blockSize)
     }
   }
 
+  MemoryResource* const resource = ResourceScope::current();
+
   if (blockSize > 0 && size >= 0)
-    if (uint8_t* buffer = reinterpret_cast<uint8_t*>(::malloc(blockSize)))
+    if (uint8_t* buffer = static_cast<uint8_t*>(resourceReallocate(resource, nullptr, 0,
+      static_cast<size_t>(blockSize))))
     {
       totalBytesRead = 0;
       Size storedBytes = 0;
@@ -144,7 +164,7 @@ Stream::Offset Stream::copy(Stream& source, Offset const size, Size blockSize)
         else
           break; // End of source stream reached and all bytes have been copied.
       }
-      ::free(buffer);
+      static_cast<void>(resourceReallocate(resource, buffer, static_cast<size_t>(blockSize), 0));
     }
 
   if (totalBytesRead == Failure)
@@ -277,7 +297,12 @@ void Stream::writeString(String const& string)
 // FileStream members.
 
 FileStream::FileStream(String const& fileName, FileMode const mode, FileAttributes const attributes)
-: _handle(invalidHandle)
+: _handle(invalidHandle),
+  _buffer(nullptr),
+  _bufferCapacity(0),
+  _bufferLength(0),
+  _bufferPosition(0),
+  _bufferWrite(false)
 {
 #ifdef _WIN32
   DWORD desiredAccess = 0;
@@ -350,26 +375,45 @@ FileStream::FileStream(String const& fileName, FileMode const mode, FileAttribut
     }
   }
 #endif
+  if (validHandle() && (mode & ModeBuffered) != 0)
+    static_cast<void>(bufferSize(DefaultBufferSize)); // Remain unbuffered if allocation fails.
 }
 
 FileStream::~FileStream()
 {
+  static_cast<void>(commitBuffer());
+  releaseBuffer();
   releaseHandle(_handle);
 }
 
 FileStream::FileStream(FileStream const& stream)
-: _handle(stream._handle)
+: _handle(stream._handle),
+  _buffer(nullptr),
+  _bufferCapacity(0),
+  _bufferLength(0),
+  _bufferPosition(0),
+  _bufferWrite(false)
 {
 }
 
 FileStream::FileStream(FileStream&& stream) noexcept
-: _handle(stream._handle)
+: _handle(stream._handle),
+  _buffer(stream._buffer),
+  _bufferCapacity(stream._bufferCapacity),
+  _bufferLength(stream._bufferLength),
+  _bufferPosition(stream._bufferPosition),
+  _bufferWrite(stream._bufferWrite)
 {
   stream._handle = invalidHandle;
+  stream._buffer = nullptr;
+  stream._bufferCapacity = stream._bufferLength = stream._bufferPosition = 0;
+  stream._bufferWrite = false;
 }
 
 FileStream& FileStream::operator = (FileStream const& stream)
 {
+  static_cast<void>(commitBuffer());
+  releaseBuffer();
   releaseHandle(_handle);
   _handle = stream._handle;
   return *this;
@@ -377,8 +421,20 @@ FileStream& FileStream::operator = (FileStream const& stream)
 
 FileStream& FileStream::operator = (FileStream&& stream) noexcept
 {
+  static_cast<void>(commitBuffer());
+  releaseBuffer();
   releaseHandle(_handle);
   utility::swap(_handle, stream._handle);
+
+  _buffer = stream._buffer;
+  _bufferCapacity = stream._bufferCapacity;
+  _bufferLength = stream._bufferLength;
+  _bufferPosition = stream._bufferPosition;
+  _bufferWrite = stream._bufferWrite;
+
+  stream._buffer = nullptr;
+  stream._bufferCapacity = stream._bufferLength = stream._bufferPosition = 0;
+  stream._bufferWrite = false;
   return *this;
 }
 
@@ -387,106 +443,108 @@ FileStream::operator bool() const
   return validHandle() && Stream::operator bool();
 }
 
-Stream::Size FileStream::read(void* const buffer, Size const size)
+Stream::Size FileStream::read(void* const buffer, Size size)
 {
-  Size bytesRead = Failure;
+  if (!validHandle() || size < 0)
+    return Failure;
 
-  if (validHandle() && size >= 0)
-  {
-    if (size)
-    {
-    #ifdef _WIN32
-      DWORD actualBytesRead;
-      if (ReadFile(_handle, buffer, static_cast<DWORD>(size), &actualBytesRead, nullptr))
-        bytesRead = static_cast<Size>(actualBytesRead);
-    #else
-      bytesRead = ::read(reinterpret_cast<intptr_t>(_handle), buffer, size);
-    #endif
-    }
-    else
-      bytesRead = 0;
-  }
-  return bytesRead;
-}
+  if (!_buffer)
+    return readHandle(buffer, size);
 
-Stream::Size FileStream::write(void const* const buffer, Size const size)
-{
-  Size bytesWritten = Failure;
+  if (_bufferWrite && !commitBuffer())
+    return Failure; // Could not write pending data.
+
+  uint8_t* dest = static_cast<uint8_t*>(buffer);
+  Size bytesRead = 0;
 
-  if (validHandle() && size >= 0)
+  while (size > 0)
   {
-    if (size)
-    {
-    #ifdef _WIN32
-      DWORD actualBytesWritten;
-      if (WriteFile(_handle, buffer, static_cast<DWORD>(size), &actualBytesWritten, nullptr))
-        bytesWritten = static_cast<Size>(actualBytesWritten);
-    #else
-      bytesWritten = ::write(reinterpret_cast<intptr_t>(_handle), buffer, size);
-    #endif
+    if (Size const available = _bufferLength - _bufferPosition)
+    { // Consume data that was read ahead.
+      Size const bytesCopy = math::min(available, size);
+      ::memcpy(dest, _buffer + _bufferPosition, static_cast<size_t>(bytesCopy));
+
+      _bufferPosition += bytesCopy;
+      dest += bytesCopy;
+      bytesRead += bytesCopy;
+      size -= bytesCopy;
+    }
+    else if (size >= _bufferCapacity)
+    { // Large requests bypass the buffer.
+      Size const bytesDirect = readHandle(dest, size);
+      if (bytesDirect < 0)
+        return bytesRead > 0 ? bytesRead : Failure;
+
+      bytesRead += bytesDirect;
+      break;
     }
     else
-      bytesWritten = 0;
+    { // Read ahead into the buffer.
+      Size const bytesAhead = readHandle(_buffer, _bufferCapacity);
+      if (bytesAhead <= 0)
+      {
+        if (bytesAhead < 0 && bytesRead == 0)
+          return Failure;
+        break; // End of file reached.
+      }
+      _bufferLength = bytesAhead;
+      _bufferPosition = 0;
+    }
   }
-  return bytesWritten;
+  return bytesRead;
 }
 
-Stream::Offset FileStream::seek(Offset const offset, SeekOrigin const origin)
+Stream::Size FileStream::write(void const* const buffer, Size const size)
 {
-  Offset position = Failure;
-
-  if (validHandle())
-  {
-  #ifdef _WIN32
-    DWORD moveMethod;
-
-    switch (origin)
-    {
-    case SeekOrigin::Current:
-      moveMethod = FILE_CURRENT;
-      break;
+  if (!validHandle() || size < 0)
+    return Failure;
 
-    case SeekOrigin::End:
-      moveMethod = FILE_END;
-      break;
+  if (!_buffer)
+    return writeHandle(buffer, size);
 
-    default:
-      moveMethod = FILE_BEGIN;
-    }
+  if (size == 0)
+    return 0;
 
-    LARGE_INTEGER temp;
-    temp.QuadPart = offset;
-    temp.LowPart = SetFilePointer(_handle, temp.LowPart, &temp.HighPart, moveMethod);
+  if ((!_bufferWrite || _bufferLength > _bufferCapacity - size) && !commitBuffer())
+    return Failure; // Could not write pending data or restore position after read-ahead.
 
-    if (temp.LowPart != INVALID_SET_FILE_POINTER || GetLastError() == NO_ERROR)
-      position = temp.QuadPart;
-  #else
-    off_t whence;
+  if (size >= _bufferCapacity)
+    return writeHandle(buffer, size); // Large requests bypass the buffer.
 
-    switch (origin)
-    {
-    case SeekOrigin::Current:
-      whence = SEEK_CUR;
-      break;
+  ::memcpy(_buffer + _bufferLength, buffer, static_cast<size_t>(size));
+  _bufferLength += size;
+  _bufferWrite = true;
+  return size;
+}
 
-    case SeekOrigin::End:
-      whence = SEEK_END;
-      break;
+Stream::Offset FileStream::seek(Offset const offset, SeekOrigin const origin)
+{
+  if (!validHandle())
+    return Failure;
 
-    default:
-      whence = SEEK_SET;
+  if (_buffer)
+  {
+    if (origin == SeekOrigin::Current && !_bufferWrite && offset >= -_bufferPosition &&
+      offset <= _bufferLength - _bufferPosition)
+    { // New position is within read-ahead data.
+      Offset const position = seekHandle(0, SeekOrigin::Current);
+      if (position == Failure)
+        return Failure;
+
+      _bufferPosition += static_cast<Size>(offset);
+      return position - (_bufferLength - _bufferPosition);
     }
-    position = lseek(reinterpret_cast<intptr_t>(_handle), offset, whence);
-  #endif
+    if (!commitBuffer())
+      return Failure;
   }
-  return position;
+  return seekHandle(offset, origin);
 }
 
 bool FileStream::truncate()
 {
   bool truncated = false;
 
-  if (validHandle())
+  if (validHandle() && commitBuffer())
   {
   #ifdef _WIN32
     truncated = SetEndOfFile(_handle);
@@ -501,7 +559,7 @@ bool FileStream::flush()
 {
   bool flushed = false;
 
-  if (validHandle())
+  if (validHandle() && commitBuffer())
   {
   #ifdef _WIN32
     flushed = FlushFileBuffers(_handle);
@@ -512,6 +570,16 @@ bool FileStream::flush()
   return flushed;
 }
 
+Stream::Offset FileStream::position()
+{
+  Offset position = validHandle() ? seekHandle(0, SeekOrigin::Current) : Failure;
+
+  if (position != Failure && _buffer)
+    position += _bufferWrite ? _bufferLength : _bufferPosition - _bufferLength;
+
+  return position;
+}
+
 Stream::Offset FileStream::size()
 {
   Offset fileSize = Failure;
@@ -527,10 +595,43 @@ Stream::Offset FileStream::size()
     if (fstat(reinterpret_cast<intptr_t>(_handle), &fileStat) == 0)
       fileSize = fileStat.st_size;
   #endif
+    if (fileSize != Failure && _bufferWrite && _bufferLength > 0)
+    { // Pending data may extend the file beyond its current size.
+      Offset const position = seekHandle(0, SeekOrigin::Current);
+      if (position != Failure)
+        fileSize = math::max(fileSize, position + _bufferLength);
+    }
   }
   return fileSize;
 }
 
+Stream::Size FileStream::bufferSize() const
+{
+  return _bufferCapacity;
+}
+
+bool FileStream::bufferSize(Size const size)
+{
+  if (size < 0 || !commitBuffer())
+    return false;
+
+  if (size != _bufferCapacity)
+  {
+    if (size > 0)
+    {
+      uint8_t* const buffer = static_cast<uint8_t*>(::realloc(_buffer, static_cast<size_t>(size)));
+      if (!buffer)
+        return false; // Memory allocation failed, keep previous buffer.
+
+      _buffer = buffer;
+      _bufferCapacity = size;
+    }
+    else
+      releaseBuffer();
+  }
+  return true;
+}
+
 FileStream::Handle FileStream::handle() const
 {
   return _handle;
@@ -672,6 +773,132 @@ bool FileStream::createDirectory(String const& directoryName)
 #endif
 }
 
+bool FileStream::commitBuffer()
+{
+  bool committed = true;
+
+  if (_bufferWrite)
+  { // Write pending data, which might take multiple attempts.
+    for (Size offset = 0; offset < _bufferLength; )
+    {
+      Size const bytesWritten = writeHandle(_buffer + offset, _bufferLength - offset);
+      if (bytesWritten <= 0)
+      {
+        committed = false; // Failed writing to the file, pending data is lost.
+        break;
+      }
+      offset += bytesWritten;
+    }
+  }
+  else if (Size const unread = _bufferLength - _bufferPosition)
+    // Move file position back to where the stream is logically located.
+    committed = seekHandle(-static_cast<Offset>(unread), SeekOrigin::Current) != Failure;
+
+  _bufferLength = _bufferPosition = 0;
+  _bufferWrite = false;
+  return committed;
+}
+
+void FileStream::releaseBuffer()
+{
+  if (_buffer)
+  {
+    ::free(_buffer);
+    _buffer = nullptr;
+  }
+  _bufferCapacity = _bufferLength = _bufferPosition = 0;
+  _bufferWrite = false;
+}
+
+Stream::Size FileStream::readHandle(void* const buffer, Size const size)
+{
+  Size bytesRead = Failure;
+
+  if (size)
+  {
+  #ifdef _WIN32
+    DWORD actualBytesRead;
+    if (ReadFile(_handle, buffer, static_cast<DWORD>(size), &actualBytesRead, nullptr))
+      bytesRead = static_cast<Size>(actualBytesRead);
+  #else
+    bytesRead = ::read(reinterpret_cast<intptr_t>(_handle), buffer, size);
+  #endif
+  }
+  else
+    bytesRead = 0;
+
+  return bytesRead;
+}
+
+Stream::Size FileStream::writeHandle(void const* const buffer, Size const size)
+{
+  Size bytesWritten = Failure;
+
+  if (size)
+  {
+  #ifdef _WIN32
+    DWORD actualBytesWritten;
+    if (WriteFile(_handle, buffer, static_cast<DWORD>(size), &actualBytesWritten, nullptr))
+      bytesWritten = static_cast<Size>(actualBytesWritten);
+  #else
+    bytesWritten = ::write(reinterpret_cast<intptr_t>(_handle), buffer, size);
+  #endif
+  }
+  else
+    bytesWritten = 0;
+
+  return bytesWritten;
+}
+
+Stream::Offset FileStream::seekHandle(Offset const offset, SeekOrigin const origin)
+{
+  Offset position = Failure;
+
+#ifdef _WIN32
+  DWORD moveMethod;
+
+  switch (origin)
+  {
+  case SeekOrigin::Current:
+    moveMethod = FILE_CURRENT;
+    break;
+
+  case SeekOrigin::End:
+    moveMethod = FILE_END;
+    break;
+
+  default:
+    moveMethod = FILE_BEGIN;
+  }
+
+  LARGE_INTEGER temp;
+  temp.QuadPart = offset;
+  temp.LowPart = SetFilePointer(_handle, temp.LowPart, &temp.HighPart, moveMethod);
+
+  if (temp.LowPart != INVALID_SET_FILE_POINTER || GetLastError() == NO_ERROR)
+    position = temp.QuadPart;
+#else
+  off_t whence;
+
+  switch (origin)
+  {
+  case SeekOrigin::Current:
+    whence = SEEK_CUR;
+    break;
+
+  case SeekOrigin::End:
+    whence = SEEK_END;
+    break;
+
+  default:
+    whence = SEEK_SET;
+  }
+  position = lseek(reinterpret_cast<intptr_t>(_handle), offset, whence);
+#endif
+
+  return position;
+}
+
 void FileStream::releaseHandle(Handle& streamHandle) const
 {
   if (streamHandle != invalidHandle)
@@ -801,14 +1028,15 @@ Stream::Size BaseMemoryStream::readBytes(void* const dest, DataType const* const
 
 // MemoryStream members.
 
-MemoryStream::MemoryStream(size_t const capacity)
+MemoryStream::MemoryStream(size_t const capacity, MemoryResource* const resource)
 : BaseMemoryStream(),
   _buffer(nullptr),
-  _capacity(0)
+  _capacity(0),
+  _resource(resource)
 {
   if (capacity)
   {
-    DataType* const buffer = static_cast<DataType*>(::malloc(capacity));
+    DataType* const buffer = static_cast<DataType*>(resourceReallocate(_resource, nullptr, 0, capacity));
     if (buffer)
     {
       _buffer = buffer;
@@ -820,11 +1048,11 @@ MemoryStream::MemoryStream(size_t const capacity)
 MemoryStream::~MemoryStream()
 {
   if (_buffer)
-    ::free(_buffer);
+    static_cast<void>(resourceReallocate(_resource, _buffer, _capacity, 0));
 }
 
 MemoryStream::MemoryStream(MemoryStream const& stream)
-: MemoryStream(stream._capacity)
+: MemoryStream(stream._capacity, stream._resource)
 {
   if (_buffer || stream._capacity == 0)
   {
@@ -838,7 +1066,8 @@ MemoryStream::MemoryStream(MemoryStream const& stream)
 MemoryStream::MemoryStream(MemoryStream&& stream) noexcept
 : BaseMemoryStream(stream),
   _buffer(stream._buffer),
-  _capacity(stream._capacity)
+  _capacity(stream._capacity),
+  _resource(stream._resource)
 {
   stream._buffer = nullptr;
   stream._capacity = 0;
@@ -860,10 +1089,11 @@ MemoryStream& MemoryStream::operator = (MemoryStream const& stream)
 MemoryStream& MemoryStream::operator = (MemoryStream&& stream) noexcept
 {
   if (_buffer)
-    ::free(_buffer);
+    static_cast<void>(resourceReallocate(_resource, _buffer, _capacity, 0));
 
   _buffer = stream._buffer;
   _capacity = stream._capacity;
+  _resource = stream._resource;
   stream._buffer = nullptr;
   stream._capacity = 0;
 
@@ -1019,11 +1249,16 @@ void MemoryStream::clear()
   _status &= ~Status::Pollute;
 }
 
+MemoryResource* MemoryStream::resource() const
+{
+  return _resource;
+}
+
 bool MemoryStream::reallocate(size_t const capacity)
 {
   bool reallocated = true;
 
-  DataType* const buffer = static_cast<DataType*>(::realloc(_buffer, capacity));
+  DataType* const buffer = static_cast<DataType*>(resourceReallocate(_resource, _buffer, _capacity, capacity));
   if (buffer || capacity == 0)
   {
     _buffer = buffer;
@@ -1035,4 +1270,174 @@ bool MemoryStream::reallocate(size_t const capacity)
   return reallocated;
 }
 
+// MappedFileStream members.
+
+MappedFileStream::MappedFileStream(String const& fileName)
+: BaseMemoryStream(),
+  _memory(nullptr)
+{
+  bool mapped = false;
+
+#ifdef _WIN32
+  if (WideString fileNameWide(fileName); fileNameWide && !fileNameWide.empty())
+  {
+    HANDLE const file = CreateFileW(fileNameWide.data(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file != INVALID_HANDLE_VALUE)
+    {
+      LARGE_INTEGER fileSize;
+      if (GetFileSizeEx(file, &fileSize) && static_cast<uint64_t>(fileSize.QuadPart) <= SIZE_MAX)
+      {
+        if (fileSize.QuadPart > 0)
+        { // View keeps the mapping alive, so both handles can be closed afterwards.
+          if (HANDLE const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+          {
+            if (void* const memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+            {
+              _memory = static_cast<DataType*>(memory);
+              _size = static_cast<size_t>(fileSize.QuadPart);
+              mapped = true;
+            }
+            CloseHandle(mapping);
+          }
+        }
+        else
+          mapped = true; // Empty file does not need to be mapped.
+      }
+      CloseHandle(file);
+    }
+  }
+#else
+  if (fileName && !fileName.empty())
+  {
+    int const file = ::open(fileName.data(), O_RDONLY);
+    if (file != -1)
+    {
+      struct stat fileStat{};
+      if (fstat(file, &fileStat) == 0 && static_cast<uint64_t>(fileStat.st_size) <= SIZE_MAX)
+      {
+        if (fileStat.st_size > 0)
+        { // Mapping remains valid after file descriptor is closed.
+          void* const memory = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE,
+            file, 0);
+          if (memory != MAP_FAILED)
+          {
+            _memory = static_cast<DataType*>(memory);
+            _size = static_cast<size_t>(fileStat.st_size);
+            mapped = true;
+          }
+        }
+        else
+          mapped = true; // Empty file does not need to be mapped.
+      }
+      close(file);
+    }
+  }
+#endif
+  if (!mapped)
+    pollute();
+}
+
+MappedFileStream::~MappedFileStream()
+{
+  unmap();
+}
+
+MappedFileStream::MappedFileStream(MappedFileStream&& stream) noexcept
+: BaseMemoryStream(static_cast<BaseMemoryStream&&>(stream)),
+  _memory(stream._memory)
+{
+  _status = stream._status;
+  stream._memory = nullptr;
+}
+
+MappedFileStream& MappedFileStream::operator = (MappedFileStream&& stream) noexcept
+{
+  unmap();
+
+  _memory = stream._memory;
+  _status = stream._status;
+  stream._memory = nullptr;
+
+  BaseMemoryStream::operator = (static_cast<BaseMemoryStream&&>(stream));
+  return *this;
+}
+
+Stream::Size MappedFileStream::read(void* const buffer, Size const size)
+{
+  return readBytes(buffer, _memory, size);
+}
+
+MappedFileStream::DataType const* MappedFileStream::memory() const
+{
+  return _memory;
+}
+
+bool MappedFileStream::advise(Access const access)
+{
+  if (!_memory)
+    return false; // Nothing is mapped.
+
+#ifdef _WIN32
+  return access == Access::Normal; // Access hints are not supported for mapped views.
+#else
+  int advice;
+
+  switch (access)
+  {
+  case Access::Sequential:
+    advice = MADV_SEQUENTIAL;
+    break;
+
+  case Access::Random:
+    advice = MADV_RANDOM;
+    break;
+
+  case Access::WillNeed:
+    advice = MADV_WILLNEED;
+    break;
+
+  default:
+    advice = MADV_NORMAL;
+  }
+  return madvise(_memory, _size, advice) == 0;
+#endif
+}
+
+String MappedFileStream::string() const
+{
+  if (!_memory)
+    return *this ? String() : String::Invalid();
+
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  size_t const pageSize = systemInfo.dwPageSize;
+#else
+  size_t const pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+  // Memory past the end of file up to the page boundary is filled with zeros, which provides null
+  // terminating character. Otherwise, the contents have to be copied.
+  if (_size <= static_cast<size_t>(String::MaxLength) && pageSize > 0 && _size % pageSize != 0)
+    return String::Wrap(reinterpret_cast<char const*>(_memory), static_cast<String::Length>(_size));
+  else
+    return String::FromRawBytes(reinterpret_cast<char const*>(_memory),
+      static_cast<String::Length>(math::min(_size, static_cast<size_t>(String::MaxLength))));
+}
+
+void MappedFileStream::unmap()
+{
+  if (_memory)
+  {
+  #ifdef _WIN32
+    UnmapViewOfFile(_memory);
+  #else
+    munmap(_memory, _size);
+  #endif
+    _memory = nullptr;
+  }
+}
+
 } // namespace trl
\ No newline at end of file
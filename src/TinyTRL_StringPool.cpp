@@ -0,0 +1,296 @@
+/*
+ * This file is part of Tiny Template and Runtime Library (TinyTRL).
+ * Copyright (c) 2024 Yuriy Kotsarenko. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+// TinyTRL_StringPool.cpp
+#include "TinyTRL_StringPool.h"
+#include "TinyTRL_Atomics.h"
+
+namespace trl {
+
+// Number of lowest hash bits that select a shard.
+static uint32_t constexpr const StringPoolShardBits = 4;
+
+// Number of slots in the first hash table of a shard.
+static size_t constexpr const StringPoolMinSlots = 64;
+
+// Size of the first memory chunk of a shard.
+static size_t constexpr const StringPoolChunkSize = 4096;
+
+static_assert(StringPool::ShardCount == 1u << StringPoolShardBits);
+
+// Interned string, which is allocated together with its characters.
+struct AtomEntry
+{
+  // Hash of the string.
+  size_t hash;
+
+  // Number of characters.
+  String::Length length;
+
+  // Characters of the string followed by a null character.
+  char chars[1];
+};
+
+// Open-addressing hash table of a shard. Slots are only ever filled, so the table can be searched without
+// locking. When the table needs to grow, it is replaced by a bigger copy, while the previous table is kept
+// until the pool is destroyed, as other threads may still be searching it.
+struct StringPoolTable
+{
+  // Table that has been replaced by this one.
+  StringPoolTable* previous;
+
+  // Number of slots minus one.
+  size_t mask;
+
+  // Entries of the strings, or NULL for unoccupied slots.
+  AtomEntry const* slots[1];
+};
+
+// Forward declarations.
+
+// Allocates hash table with the given number of slots, moving all entries of the given table to it.
+static StringPoolTable* stringPoolTable(size_t slots, StringPoolTable const* table);
+
+// Atom members.
+
+Atom::Atom() noexcept
+: _entry(nullptr)
+{
+}
+
+Atom::Atom(AtomEntry const* const entry) noexcept
+: _entry(entry)
+{
+}
+
+String Atom::string() const
+{
+  return _entry ? String::Wrap(_entry->chars, _entry->length) : String();
+}
+
+char const* Atom::data() const noexcept
+{
+  return _entry ? _entry->chars : "";
+}
+
+String::Length Atom::length() const noexcept
+{
+  return _entry ? _entry->length : 0;
+}
+
+size_t Atom::hash() const noexcept
+{
+  return _entry ? _entry->hash : utility::hash("", 0);
+}
+
+bool Atom::empty() const noexcept
+{
+  return !_entry;
+}
+
+bool Atom::operator == (Atom const& atom) const noexcept
+{
+  return _entry == atom._entry;
+}
+
+bool Atom::operator != (Atom const& atom) const noexcept
+{
+  return _entry != atom._entry;
+}
+
+bool Atom::operator < (Atom const& atom) const noexcept
+{
+  return reinterpret_cast<uintptr_t>(_entry) < reinterpret_cast<uintptr_t>(atom._entry);
+}
+
+// StringPool::Shard members.
+
+StringPool::Shard::Shard() noexcept
+: table(nullptr),
+  length(0),
+  lock(0),
+  arena(StringPoolChunkSize)
+{
+}
+
+// StringPool members.
+
+StringPool::StringPool() noexcept
+: _status(0)
+{
+}
+
+StringPool::~StringPool()
+{
+  for (Shard& shard : _shards)
+    while (StringPoolTable* const table = shard.table)
+    {
+      shard.table = table->previous;
+      ::free(table);
+    }
+}
+
+StringPool::operator bool () const
+{
+  return !atomicLoad(_status);
+}
+
+String::Length StringPool::length() const
+{
+  String::Length length = 0;
+
+  for (Shard const& shard : _shards)
+    length += static_cast<String::Length>(atomicLoad(shard.length));
+
+  return length;
+}
+
+Atom StringPool::intern(String const& string)
+{
+  return intern(string.data(), string.length());
+}
+
+Atom StringPool::intern(char const* const string, String::Length const length)
+{
+  if (length <= 0)
+    return Atom();
+
+  size_t const hash = utility::hash(string, length);
+  Shard& shard = _shards[hash & (ShardCount - 1)];
+
+  AtomEntry const* entry = search(shard, string, length, hash);
+  if (!entry)
+    entry = insert(shard, string, length, hash);
+
+  return Atom(entry);
+}
+
+Atom StringPool::find(String const& string) const
+{
+  return find(string.data(), string.length());
+}
+
+Atom StringPool::find(char const* const string, String::Length const length) const
+{
+  if (length <= 0)
+    return Atom();
+
+  size_t const hash = utility::hash(string, length);
+  return Atom(search(_shards[hash & (ShardCount - 1)], string, length, hash));
+}
+
+AtomEntry const* StringPool::search(Shard const& shard, char const* const string, String::Length const length,
+  size_t const hash)
+{
+  if (StringPoolTable const* const table = atomicLoad(shard.table))
+    for (size_t position = (hash >> StringPoolShardBits) & table->mask;; position = (position + 1) & table->mask)
+    {
+      AtomEntry const* const entry = atomicLoad(table->slots[position]);
+      if (!entry)
+        break;
+
+      if (entry->hash == hash && entry->length == length && ::memcmp(entry->chars, string, length) == 0)
+        return entry;
+    }
+
+  return nullptr;
+}
+
+AtomEntry const* StringPool::insert(Shard& shard, char const* const string, String::Length const length,
+  size_t const hash)
+{
+  atomicLock(shard.lock);
+
+  // Another thread may have added the same string while waiting for the lock.
+  AtomEntry* entry = const_cast<AtomEntry*>(search(shard, string, length, hash));
+
+  if (!entry)
+  {
+    StringPoolTable* table = shard.table;
+
+    // Table is kept at most half full, so that searches remain short and always reach an unoccupied slot.
+    if (!table || (shard.length + 1) * 2 > table->mask + 1)
+    {
+      table = stringPoolTable(table ? (table->mask + 1) * 2 : StringPoolMinSlots, table);
+      if (table)
+        atomicStore(shard.table, table);
+    }
+
+    if (table)
+      entry = static_cast<AtomEntry*>(shard.arena.alloc(offsetof(AtomEntry, chars) + length + 1,
+        alignof(AtomEntry)));
+
+    if (entry)
+    {
+      entry->hash = hash;
+      entry->length = length;
+      ::memcpy(entry->chars, string, length);
+      entry->chars[length] = 0;
+
+      size_t position = (hash >> StringPoolShardBits) & table->mask;
+      while (table->slots[position])
+        position = (position + 1) & table->mask;
+
+      atomicStore(table->slots[position], static_cast<AtomEntry const*>(entry));
+      atomicStore(shard.length, shard.length + 1);
+    }
+    else
+      atomicStore(_status, 1);
+  }
+  atomicUnlock(shard.lock);
+
+  return entry;
+}
+
+// Helper functions.
+
+StringPoolTable* stringPoolTable(size_t const slots, StringPoolTable const* const table)
+{
+  StringPoolTable* const newTable = static_cast<StringPoolTable*>(::calloc(1,
+    offsetof(StringPoolTable, slots) + slots * sizeof(AtomEntry const*)));
+
+  if (newTable)
+  {
+    newTable->previous = const_cast<StringPoolTable*>(table);
+    newTable->mask = slots - 1;
+
+    if (table)
+      for (size_t i = 0; i <= table->mask; ++i)
+        if (AtomEntry const* const entry = table->slots[i])
+        {
+          size_t position = (entry->hash >> StringPoolShardBits) & newTable->mask;
+          while (newTable->slots[position])
+            position = (position + 1) & newTable->mask;
+
+          newTable->slots[position] = entry;
+        }
+  }
+  return newTable;
+}
+
+// Service functors.
+
+namespace utility {
+
+size_t AtomHasher::operator () (Atom const& value) const
+{
+  return value.hash();
+}
+
+bool AtomHasher::operator () (Atom const& left, Atom const& right) const
+{
+  return left == right;
+}
+
+} // namespace utility
+} // namespace trl
@@ -12,6 +12,7 @@
  */
 
 #include "TinyTRL_Timing.h"
+#include "TinyTRL_Atomics.h"
 
 #ifdef _WIN32
   #define WIN32_LEAN_AND_MEAN
@@ -24,29 +25,23 @@
 namespace trl {
 
 // Forward declarations.
-#ifndef _WIN32
 
-  // Returns current value of monotonic clock.
-  static TickCount readClockMonotonic();
+// Returns current value of the monotonic clock in platform-specific units, or zero on failure.
+static uint64_t readClockMonotonic();
 
-#endif
+// Atomically stores the given value to a variable if it is still zero, returning the variable's value.
+static uint64_t initializeOnce(uint64_t& variable, uint64_t value);
 
 // Global variables.
 
-#ifdef _WIN32
-  // Running frequency of a QPC.
-  static LARGE_INTEGER counterFrequency;
+// Value of the monotonic clock acquired during initialization, or zero if not yet initialized.
+static uint64_t timingStart = 0;
 
-  // Value of a QPC retrieved during initialization.
-  static LARGE_INTEGER counterStart;
-#else
-  // Time acquired during initialization.
-  static TickCount timingStart;
+#ifdef _WIN32
+  // Running frequency of a QPC, or zero if not yet initialized.
+  static uint64_t counterFrequency = 0;
 #endif
 
-// Whether the calculations have been performed.
-static bool timingStartCalculated = false;
-
 // Global functions.
 
 #ifdef _WIN32
@@ -82,29 +77,40 @@ static bool timingStartCalculated = false;
       SwitchToThread();
   }
 
-  TickCount timingTickCountUS()
+  TickCount timingTickCountNS()
   {
-    if (!timingStartCalculated)
+    uint64_t frequency = atomicLoadRelaxed(counterFrequency);
+    if (!frequency)
     {
-      bool const supported =
-        QueryPerformanceFrequency(&counterFrequency) && counterFrequency.QuadPart &&
-        QueryPerformanceCounter(&counterStart);
-
-      if (!supported)
-        counterFrequency = {};
+      LARGE_INTEGER value = {};
+      if (!QueryPerformanceFrequency(&value) || !value.QuadPart)
+        return 0; // Not supported.
 
-      timingStartCalculated = true;
+      frequency = initializeOnce(counterFrequency, static_cast<uint64_t>(value.QuadPart));
     }
-    if (counterFrequency.QuadPart)
-    {
-      LARGE_INTEGER counter = {};
-      QueryPerformanceCounter(&counter);
+    uint64_t const counter = readClockMonotonic();
 
-      return (static_cast<uint64_t>(counter.QuadPart - counterStart.QuadPart) * 1000000ul) /
-        static_cast<uint64_t>(counterFrequency.QuadPart);
-    }
+    uint64_t start = atomicLoadRelaxed(timingStart);
+    if (!start)
+      start = initializeOnce(timingStart, counter);
+
+    if (counter <= start)
+      return 0; // Another thread has initialized the clock after the counter was read.
+
+    // Convert in two steps to avoid overflow of intermediate result.
+    uint64_t const elapsed = counter - start;
+    return (elapsed / frequency) * 1000000000ull + ((elapsed % frequency) * 1000000000ull) / frequency;
+  }
+
+  uint64_t readClockMonotonic()
+  {
+    LARGE_INTEGER counter = {};
+
+    // Note: one is added so that a valid clock reading is never zero.
+    if (QueryPerformanceCounter(&counter))
+      return static_cast<uint64_t>(counter.QuadPart) + 1u;
     else
-      return 0; // Not supported.
+      return 0;
   }
 
 #else
@@ -125,29 +131,44 @@ static bool timingStartCalculated = false;
     nanosleep(&time, nullptr);
   }
 
-  TickCount timingTickCountUS()
+  TickCount timingTickCountNS()
   {
-    TickCount const ticks = readClockMonotonic();
-    if (!timingStartCalculated)
-    {
-      timingStart = ticks;
-      timingStartCalculated = true;
-    }
-    return ticks - timingStart;
+    uint64_t const ticks = readClockMonotonic();
+
+    uint64_t start = atomicLoadRelaxed(timingStart);
+    if (!start)
+      start = initializeOnce(timingStart, ticks);
+
+    // Note: another thread may have initialized the clock after the ticks were read.
+    return ticks > start ? ticks - start : 0;
   }
 
-  TickCount readClockMonotonic()
+  uint64_t readClockMonotonic()
   {
     struct timespec time = {};
 
-    if (clock_gettime(CLOCK_MONOTONIC_RAW, &time) == 0)
-      return static_cast<uint64_t>(time.tv_sec) * 1000000u + (time.tv_nsec / 1000u);
+    // Note: one is added so that a valid clock reading is never zero.
+    if (clock_gettime(CLOCK_MONOTONIC, &time) == 0)
+      return static_cast<uint64_t>(time.tv_sec) * 1000000000u + static_cast<uint64_t>(time.tv_nsec) + 1u;
     else
       return 0;
   }
 
 #endif
 
+uint64_t initializeOnce(uint64_t& variable, uint64_t const value)
+{
+  if (atomicCompareExchange(variable, 0, value))
+    return value;
+  else
+    return atomicLoadRelaxed(variable); // Variable never changes again once it is not zero.
+}
+
+TickCount timingTickCountUS()
+{
+  return timingTickCountNS() / 1000u;
+}
+
 uint32_t timingTickCount()
 {
   return static_cast<uint32_t>(timingTickCountUS() / 1000u);